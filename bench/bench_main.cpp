@@ -0,0 +1,384 @@
+#include "Advancements.hpp"
+#include "IconStore.hpp"
+#include "ManifestCache.hpp"
+#include "Overlay.hpp"
+#include "ResampleCache.hpp"
+#include "ResourceManager.hpp"
+#include "RingBuffer.hpp"
+#include "Tile.hpp"
+#include "TurnTable.hpp"
+#include "logging.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * bench_main.cpp
+ *
+ * trAAcker_bench - times the hot paths of trAAcker: manifest loading, status
+ * parsing (every .json fixture in testing/), overlay rebuilds, icon loading and
+ * turntable traversal/batching. Run from the repository root, it needs advancements.json,
+ * assets/ and testing/. No network, no windows.
+ *
+ * Usage: trAAcker_bench [iterations] [filter]
+ *   iterations - timed iterations per case (default 100)
+ *   filter     - only run cases whose name contains this
+ *
+ * Output is CSV on stdout, one row per case, so runs can be diffed between versions:
+ *   case,iterations,min_us,median_us,p99_us,allocs_per_iter,bytes_per_iter
+ */
+
+// Allocation counting. Replacing the global operator new is the only way to see
+// allocations made inside nlohmann/SFML/the standard library. Over-aligned
+// allocations don't go through these, but nothing we benchmark uses them.
+namespace
+{
+std::atomic<uint64_t> allocation_count{0};
+std::atomic<uint64_t> allocation_bytes{0};
+
+void* counted_alloc(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc{};
+}
+} // namespace
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+
+struct Options
+{
+    uint64_t iterations = 100;
+    std::string filter;
+};
+
+// Times every iteration separately, so we get a distribution instead of a mean.
+template <typename F>
+void run_case(const Options& opts, const std::string& name, F&& f, uint64_t max_iterations = 0)
+{
+    if (not opts.filter.empty() && name.find(opts.filter) == std::string::npos) return;
+
+    const auto iterations =
+        max_iterations ? std::min(opts.iterations, max_iterations) : opts.iterations;
+    if (iterations == 0) return;
+
+    // Warm up once, so the first run doesn't pay for cold caches.
+    f();
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    const auto allocs_before = allocation_count.load(std::memory_order_relaxed);
+    const auto bytes_before  = allocation_bytes.load(std::memory_order_relaxed);
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        const auto start = clock_type::now();
+        f();
+        const auto elapsed = clock_type::now() - start;
+        samples.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+    // samples was reserved up front, so this only counts what f() allocated.
+    const auto allocs = allocation_count.load(std::memory_order_relaxed) - allocs_before;
+    const auto bytes  = allocation_bytes.load(std::memory_order_relaxed) - bytes_before;
+
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&](double p)
+    { return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))]; };
+
+    std::cout << name << "," << iterations << "," << samples.front() << "," << percentile(0.5)
+              << "," << percentile(0.99) << ","
+              << static_cast<double>(allocs) / static_cast<double>(iterations) << ","
+              << static_cast<double>(bytes) / static_cast<double>(iterations) << std::endl;
+}
+
+std::vector<std::string> fixtures()
+{
+    namespace fs = std::filesystem;
+
+    std::vector<std::string> result;
+    for (const auto& dir_entry : fs::directory_iterator{"testing"})
+    {
+        if (dir_entry.path().extension() == ".json") result.push_back(dir_entry.path().string());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// Stops the optimizer from throwing away results we never look at.
+volatile const void* sink = nullptr;
+
+template <typename T>
+void keep(T&& value)
+{
+    sink = &value;
+}
+
+/* Marking criteria complete, then walking what's left (what the overlay does).
+ * "legacy" is how AdvancementStatus used to do it: every incomplete advancement
+ * owned a copy of its criteria, as a hash map plus an ordered vector, and each
+ * criterion in the file cost a std::find + erase on the vector. That's quadratic
+ * for Adventuring Time & co. "bitset" is what we do now: one bit per criterion,
+ * indexed by manifest ordinal. Both skip the JSON parsing, so this is just the
+ * container work for one parse of the fixture.
+ */
+bool criteria_cases(const Options& opts, const aa::AdvancementManifest& manifest,
+                    const std::string& fixture)
+{
+    const auto status = aa::AdvancementStatus::from_file(fixture, manifest);
+    const auto stem   = std::filesystem::path{fixture}.stem().string();
+
+    // Done criteria of every incomplete advancement, as the file lists them.
+    std::vector<std::pair<uint32_t, std::vector<std::string>>> done;
+    for (const auto& adv : manifest.advancements)
+    {
+        if (status.complete.test(adv.ordinal)) continue;
+        auto& [ordinal, keys] = done.emplace_back(adv.ordinal, std::vector<std::string>{});
+        status.criteria.for_each_set_in(adv.criteria_begin, adv.criteria_end, [&](size_t i)
+                                        { keys.push_back(manifest.criteria[i].key); });
+    }
+
+    struct LegacyAdvancement
+    {
+        string_map<aa::Icon> criteria;
+        std::vector<std::string> criteria_ordered;
+    };
+    std::vector<LegacyAdvancement> legacy_default;
+    for (const auto& adv : manifest.advancements)
+    {
+        auto& legacy = legacy_default.emplace_back();
+        for (auto i = adv.criteria_begin; i < adv.criteria_end; i++)
+        {
+            legacy.criteria.emplace(manifest.criteria[i].key, manifest.criteria[i].icon);
+            legacy.criteria_ordered.push_back(manifest.criteria[i].key);
+        }
+    }
+
+    // Both hand every remaining criterion key to visit, in order.
+    const auto legacy = [&](auto&& visit)
+    {
+        auto advs = legacy_default;
+        for (const auto& [ordinal, keys] : done)
+        {
+            auto& adv = advs[ordinal];
+            for (const auto& key : keys)
+            {
+                adv.criteria_ordered.erase(std::find(adv.criteria_ordered.begin(),
+                                                     adv.criteria_ordered.end(), key));
+                adv.criteria.erase(key);
+            }
+        }
+        for (const auto& [ordinal, keys] : done)
+        {
+            for (const auto& key : advs[ordinal].criteria_ordered) visit(key);
+        }
+    };
+    const auto bitset = [&](auto&& visit)
+    {
+        auto fresh = aa::AdvancementStatus::from_default(manifest);
+        for (const auto& [ordinal, keys] : done)
+        {
+            const auto& adv = manifest.advancements[ordinal];
+            for (const auto& key : keys)
+            {
+                // The parser looks criteria up the same way.
+                fresh.criteria.set(adv.criteria.find(key)->second);
+            }
+        }
+        for (const auto& [ordinal, keys] : done)
+        {
+            fresh.for_each_remaining_criterion(manifest.advancements[ordinal],
+                                               [&](const aa::Criterion& crit)
+                                               { visit(crit.key); });
+        }
+    };
+
+    // Timing the wrong answer is pointless. Fixtures with partially complete
+    // advancements are where these can actually disagree.
+    std::vector<std::string> legacy_keys, bitset_keys;
+    legacy([&](const std::string& key) { legacy_keys.push_back(key); });
+    bitset([&](const std::string& key) { bitset_keys.push_back(key); });
+    if (legacy_keys != bitset_keys)
+    {
+        std::cerr << "criteria_remaining: legacy and bitset disagree on " << stem << " ("
+                  << legacy_keys.size() << " vs " << bitset_keys.size() << " remaining)"
+                  << std::endl;
+        return false;
+    }
+
+    run_case(opts, "criteria_remaining_legacy:" + stem,
+             [&]
+             {
+                 size_t remaining = 0;
+                 legacy([&](const std::string& key) { remaining += key.size(); });
+                 keep(remaining);
+             });
+    run_case(opts, "criteria_remaining_bitset:" + stem,
+             [&]
+             {
+                 size_t remaining = 0;
+                 bitset([&](const std::string& key) { remaining += key.size(); });
+                 keep(remaining);
+             });
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Sets up the log files before anything logs.
+    [[maybe_unused]] const auto& files = aa::detail::get_files();
+    // We are timing, not debugging. Keep everything quiet.
+    aa::Logger::set_level("error");
+
+    Options opts;
+    if (argc > 1) opts.iterations = std::stoull(argv[1]);
+    if (argc > 2) opts.filter = argv[2];
+
+    std::cout << "case,iterations,min_us,median_us,p99_us,allocs_per_iter,bytes_per_iter"
+              << std::endl;
+
+    // Loading criteria textures happens once per process, keep it out of the timings.
+    auto& rm = aa::ResourceManager::instance();
+
+    run_case(opts, "manifest_from_file",
+             [&] { keep(aa::AdvancementManifest::from_file("advancements.json")); });
+
+    {
+        namespace fs     = std::filesystem;
+        const auto cache = (fs::temp_directory_path() / "trAAcker_bench.cache").string();
+        aa::ManifestCache::store(cache, "advancements.json",
+                                 aa::AdvancementManifest::from_file("advancements.json"));
+        run_case(opts, "manifest_cache_load",
+                 [&] { keep(aa::ManifestCache::load(cache, "advancements.json")); });
+        std::error_code ec;
+        fs::remove(cache, ec);
+    }
+
+    auto manifest = aa::AdvancementManifest::from_file("advancements.json");
+
+    for (const auto& fixture : fixtures())
+    {
+        const auto stem = std::filesystem::path{fixture}.stem().string();
+        run_case(opts, "status_from_file:" + stem,
+                 [&] { keep(aa::AdvancementStatus::from_file(fixture, manifest)); });
+        run_case(opts, "status_from_file_dom:" + stem,
+                 [&] { keep(aa::AdvancementStatus::from_file_dom(fixture, manifest)); });
+    }
+
+    for (const auto& fixture : fixtures())
+    {
+        if (not criteria_cases(opts, manifest, fixture)) return 1;
+    }
+
+    run_case(opts, "status_from_default",
+             [&] { keep(aa::AdvancementStatus::from_default(manifest)); });
+
+    aa::OverlayManager ov(manifest);
+    {
+        const auto none = aa::AdvancementStatus::from_default(manifest);
+        const auto less = aa::AdvancementStatus::from_file("testing/less.json", manifest);
+        run_case(opts, "overlay_reset_from_status:default",
+                 [&] { ov.reset_from_status(none); });
+        run_case(opts, "overlay_reset_from_status:less", [&] { ov.reset_from_status(less); });
+    }
+
+    {
+        // What a cache miss costs on top of decoding: a 16px criteria icon drawn at
+        // 48px, and a 64px one drawn at 32px.
+        const std::vector<uint8_t> small(16 * 16 * 4, 0x80), large(64 * 64 * 4, 0x80);
+        run_case(opts, "icon_resample:16->48",
+                 [&] { keep(aa::ResampleCache::resample(small.data(), 16, 16, 48).size()); });
+        run_case(opts, "icon_resample:64->32",
+                 [&] { keep(aa::ResampleCache::resample(large.data(), 64, 64, 32).size()); });
+    }
+
+    if (not rm.criteria_map.empty())
+    {
+        // Loading every criteria icon from scratch, at double size (the native size
+        // would be cheaper than what the overlay usually does), into a fresh store.
+        // Every iteration keeps its atlas alive forever, so don't do too many of these.
+        std::vector<aa::Icon> all;
+        for (const auto& [_, icon] : rm.criteria_map) all.push_back(icon);
+        std::vector<std::unique_ptr<aa::IconStore>> stores;
+        run_case(opts, "icon_prefetch_cold",
+                 [&]
+                 {
+                     auto& store = *stores.emplace_back(std::make_unique<aa::IconStore>());
+                     std::vector<aa::Icon> icons;
+                     for (const auto icon : all)
+                     {
+                         icons.push_back(store.intern(rm.icons.path(icon)));
+                     }
+                     store.prefetch(icons, 32);
+                     store.wait();
+                     keep(store.resident());
+                 },
+                 10);
+    }
+
+    {
+        // Same access pattern as TurnTable::animateDraw: a window's worth of tiles
+        // starting at pos_, then shift.
+        aa::RingBuffer<aa::Tile> rb;
+        for (const auto& adv : manifest.advancements)
+        {
+            rb.buf().emplace_back(adv.pretty_name, adv.icon, false, adv.ordinal);
+        }
+        constexpr uint64_t window = 1920 / 56 + 2;
+        run_case(opts, "ring_buffer_traversal",
+                 [&]
+                 {
+                     uint64_t sum = 0;
+                     for (uint64_t i = 0; i < window; i++) sum += rb.get(i).id;
+                     rb.shift();
+                     keep(sum);
+                 });
+
+        // What TurnTable::animateDraw does for the icons of a window's worth of tiles,
+        // minus the draw call itself.
+        aa::TurnTable table;
+        for (const auto& adv : manifest.advancements)
+        {
+            table.emplace(adv.pretty_name, adv.icon, false, adv.ordinal);
+        }
+        const auto size = static_cast<uint32_t>(table.get_texture_size());
+        // Loads happen in the background, so get every icon resident up front.
+        std::vector<aa::Icon> all_tiles;
+        for (const auto& tile : table.rb_.buf()) all_tiles.push_back(tile.icon);
+        rm.icons.prefetch(all_tiles, size);
+        rm.icons.wait();
+        run_case(opts, "turntable_batch",
+                 [&]
+                 {
+                     for (auto& [_, vertices] : table.batches_) vertices.clear();
+                     for (uint64_t i = 0; i < window; i++)
+                     {
+                         const auto region = rm.icons.resolve(table.rb_.get(i).icon, size);
+                         if (region.texture == nullptr) continue;
+                         aa::TurnTable::append_quad(table.batch(region.texture),
+                                                    static_cast<float>(i * 56), 0, region.rect);
+                     }
+                     table.rb_.shift();
+                     keep(table.batches_.size());
+                 });
+    }
+
+    return 0;
+}
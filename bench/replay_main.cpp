@@ -0,0 +1,342 @@
+#include "Advancements.hpp"
+#include "FileProvider.hpp"
+#include "StatusParser.hpp"
+#include "logging.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * replay_main.cpp
+ *
+ * trAAcker_replay - replays a recorded save sequence (see bench/replays/) into a
+ * temporary instance directory, while a headless CurrentFileProvider + StatusParser
+ * watch it the same way the main loop does. For every filesystem event, reports how
+ * long it took to notice it and to parse it, or what happened to it instead. Run from
+ * the repository root, it needs advancements.json and testing/.
+ *
+ * Usage: trAAcker_replay <script> [speed] [native|poll]
+ *   speed - replay this many times faster than recorded (default 1)
+ *   mode  - use native directory notifications (default), or force polling
+ *
+ * Script lines are "<at_ms> <op> <args...>", with paths relative to the instance
+ * (quote the ones with spaces). Ops:
+ *   mkdir <dir>
+ *   save <file> <source>  - what the game does: write <file>.tmp, rename it over <file>
+ *   write <file> <source> - rewrite <file> in place, in two halves, 5ms apart
+ *   rename <from> <to>
+ *   remove <path>
+ *
+ * Output is CSV on stdout, one row per save/write:
+ *   event,at_ms,op,file,detect_ms,parse_ms,outcome
+ * outcome is one of parsed (useful parse), redundant (parsed, but nothing changed),
+ * invalid (parsed a broken file), coalesced (folded into a later event), skipped
+ * (filtered out by the content check, e.g. an identical autosave), missed.
+ * A summary follows, as # comments.
+ */
+
+namespace
+{
+namespace fs     = std::filesystem;
+using clock_type = std::chrono::steady_clock;
+
+struct Op
+{
+    std::chrono::milliseconds at;
+    std::string op;
+    std::vector<std::string> args;
+};
+
+std::vector<Op> load_script(const std::string& filename)
+{
+    std::ifstream f(filename);
+    if (not f.good())
+    {
+        aa::get_logger("Replay").fatal_error("Could not open replay script: ", filename);
+    }
+
+    std::vector<Op> ops;
+    std::string line;
+    while (std::getline(f, line))
+    {
+        std::istringstream in{line};
+        uint64_t at = 0;
+        Op op;
+        if (line.empty() || line[0] == '#' || not(in >> at >> op.op)) continue;
+        op.at = std::chrono::milliseconds{at};
+        for (std::string arg; in >> std::quoted(arg);)
+        {
+            op.args.push_back(std::move(arg));
+        }
+        ops.push_back(std::move(op));
+    }
+    return ops;
+}
+
+std::string slurp(const std::string& filename)
+{
+    std::ifstream f(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{}};
+}
+
+void spit(const fs::path& path, std::string_view contents)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+enum class Outcome
+{
+    Missed,
+    Coalesced,
+    Skipped,
+    Parsed,
+    Redundant,
+    Invalid,
+};
+
+const char* to_string(Outcome o)
+{
+    switch (o)
+    {
+    case Outcome::Missed: return "missed";
+    case Outcome::Coalesced: return "coalesced";
+    case Outcome::Skipped: return "skipped";
+    case Outcome::Parsed: return "parsed";
+    case Outcome::Redundant: return "redundant";
+    case Outcome::Invalid: return "invalid";
+    }
+    return "?";
+}
+
+// One save/write, i.e. something that should end up parsed.
+struct Event
+{
+    const Op* op;
+    std::string file;
+    // Set by the replay thread once the write is complete.
+    std::optional<clock_type::time_point> done;
+    std::optional<double> detect_ms;
+    std::optional<double> parse_ms;
+    Outcome outcome = Outcome::Missed;
+};
+
+double ms_between(clock_type::time_point a, clock_type::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+double median(std::vector<double> v)
+{
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Sets up the log files before anything logs.
+    [[maybe_unused]] const auto& files = aa::detail::get_files();
+    aa::Logger::set_level("error");
+
+    if (argc < 2)
+    {
+        std::cerr << "Usage: trAAcker_replay <script> [speed] [native|poll]" << std::endl;
+        return 1;
+    }
+    const auto ops     = load_script(argv[1]);
+    const double speed = argc > 2 ? std::stod(argv[2]) : 1.0;
+    const bool native  = argc > 3 ? std::string_view{argv[3]} != "poll" : true;
+
+    const auto root = fs::temp_directory_path() / "trAAcker_replay";
+    fs::remove_all(root);
+    fs::create_directories(root / ".minecraft" / "saves");
+
+    std::mutex mutex;
+    std::vector<Event> events;
+    for (const auto& op : ops)
+    {
+        if (op.op == "save" || op.op == "write")
+        {
+            events.push_back({&op, (root / op.args.at(0)).string()});
+        }
+    }
+
+    auto manifest = aa::AdvancementManifest::from_file("advancements.json");
+    aa::CurrentFileProvider fp({root.string()}, aa::PollScheduler::Options{}, native);
+    aa::StatusParser parser(manifest);
+
+    // The "game". Applies every op at its (scaled) time.
+    std::atomic<bool> finished{false};
+    std::thread game(
+        [&]
+        {
+            const auto start = clock_type::now();
+            size_t next_event = 0;
+            for (const auto& op : ops)
+            {
+                std::this_thread::sleep_until(
+                    start + std::chrono::duration_cast<clock_type::duration>(op.at / speed));
+                const auto path = [&](size_t i) { return root / op.args.at(i); };
+
+                if (op.op == "mkdir") fs::create_directories(path(0));
+                else if (op.op == "rename") fs::rename(path(0), path(1));
+                else if (op.op == "remove") fs::remove_all(path(0));
+                else if (op.op == "save")
+                {
+                    auto tmp = path(0);
+                    tmp += ".tmp";
+                    spit(tmp, slurp(op.args.at(1)));
+                    fs::rename(tmp, path(0));
+                }
+                else if (op.op == "write")
+                {
+                    const auto contents = slurp(op.args.at(1));
+                    const auto half     = contents.size() / 2;
+                    spit(path(0), std::string_view{contents}.substr(0, half));
+                    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+                    std::ofstream f(path(0), std::ios::binary | std::ios::app);
+                    f << std::string_view{contents}.substr(half);
+                }
+                else
+                {
+                    std::cerr << "Ignoring unknown op: " << op.op << std::endl;
+                    continue;
+                }
+
+                if (op.op == "save" || op.op == "write")
+                {
+                    std::lock_guard lock{mutex};
+                    events[next_event++].done = clock_type::now();
+                }
+            }
+            finished = true;
+        });
+
+    // The "main loop". loop-sleep 1, same as the default.
+    std::optional<size_t> in_flight;
+    clock_type::time_point requested_at;
+    std::optional<aa::AdvancementStatus> previous;
+    std::optional<clock_type::time_point> settle_until;
+    uint64_t avoided = 0;
+    while (true)
+    {
+        const auto now = clock_type::now();
+        if (finished && not settle_until.has_value())
+        {
+            // Give the debounce/backoff time to catch up with the last event.
+            settle_until = now + fp.scheduler().options().max * 2;
+        }
+        if (settle_until.has_value() && now > *settle_until) break;
+
+        auto file = fp.poll();
+        if (parser.parses_avoided() != avoided)
+        {
+            // Read, and found identical. Whatever was in flight is accounted for.
+            avoided = parser.parses_avoided();
+            std::lock_guard lock{mutex};
+            if (in_flight.has_value() && not events[*in_flight].parse_ms.has_value())
+            {
+                events[*in_flight].parse_ms = ms_between(requested_at, clock_type::now());
+                events[*in_flight].outcome  = Outcome::Skipped;
+                in_flight.reset();
+            }
+        }
+        if (file.has_value())
+        {
+            std::lock_guard lock{mutex};
+            // The newest completed event for this file is the one we noticed, anything
+            // older that was still waiting got folded into it.
+            std::optional<size_t> latest;
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                auto& ev = events[i];
+                if (ev.file != *file || not ev.done.has_value() || ev.detect_ms.has_value() ||
+                    ev.outcome != Outcome::Missed)
+                    continue;
+                if (latest.has_value()) events[*latest].outcome = Outcome::Coalesced;
+                latest = i;
+            }
+            if (latest.has_value())
+            {
+                events[*latest].detect_ms = ms_between(*events[*latest].done, now);
+                if (in_flight.has_value() && not events[*in_flight].parse_ms.has_value())
+                {
+                    // About to be dropped by the parser.
+                    events[*in_flight].outcome = Outcome::Coalesced;
+                }
+                in_flight    = latest;
+                requested_at = now;
+            }
+            parser.request(std::move(*file));
+        }
+
+        if (auto status = parser.take(); status.has_value() && in_flight.has_value())
+        {
+            std::lock_guard lock{mutex};
+            auto& ev    = events[*in_flight];
+            ev.parse_ms = ms_between(requested_at, clock_type::now());
+            if (not status->meta.valid)
+            {
+                ev.outcome = Outcome::Invalid;
+            }
+            else
+            {
+                const bool same = previous.has_value() &&
+                                  aa::StatusDelta::diff(*previous, *status).empty();
+                ev.outcome = same ? Outcome::Redundant : Outcome::Parsed;
+                previous   = std::move(*status);
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    game.join();
+
+    std::cout << "event,at_ms,op,file,detect_ms,parse_ms,outcome" << std::endl;
+    std::vector<double> detect, parse;
+    size_t counts[6] = {};
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const auto& ev = events[i];
+        std::cout << i << "," << ev.op->at.count() << "," << ev.op->op << ","
+                  << fs::path{ev.file}.filename().string() << ",";
+        if (ev.detect_ms) std::cout << *ev.detect_ms;
+        std::cout << ",";
+        if (ev.parse_ms) std::cout << *ev.parse_ms;
+        std::cout << "," << to_string(ev.outcome) << std::endl;
+
+        if (ev.detect_ms) detect.push_back(*ev.detect_ms);
+        if (ev.parse_ms) parse.push_back(*ev.parse_ms);
+        counts[static_cast<size_t>(ev.outcome)] += 1;
+    }
+
+    const auto wasted = counts[static_cast<size_t>(Outcome::Redundant)] +
+                        counts[static_cast<size_t>(Outcome::Invalid)] + parser.dropped();
+    std::cout << "# mode: " << (fp.is_native() ? "native" : "poll") << ", speed: " << speed
+              << std::endl;
+    std::cout << "# events: " << events.size()
+              << ", parsed: " << counts[static_cast<size_t>(Outcome::Parsed)]
+              << ", coalesced: " << counts[static_cast<size_t>(Outcome::Coalesced)]
+              << ", skipped: " << counts[static_cast<size_t>(Outcome::Skipped)]
+              << ", missed: " << counts[static_cast<size_t>(Outcome::Missed)] << std::endl;
+    std::cout << "# median detect_ms: " << median(detect) << ", median parse_ms: " << median(parse)
+              << std::endl;
+    std::cout << "# wasted parses: " << wasted << " (redundant + invalid + dropped by the parser)"
+              << ", avoided by the content check: " << parser.parses_avoided() << std::endl;
+
+    fs::remove_all(root);
+    return 0;
+}
@@ -373,6 +373,109 @@ inline std::optional<std::string> aa::get_focused_minecraft()
 
 #elif __linux__
 // Linux specific code for getting the current application details.
+#include "linux/ProcessTable.hpp"
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+
+namespace
+{
+XErrorHandler previous_handler = nullptr;
+
+// The focused window can be gone by the time we ask about it. Xlib's default
+// handler would exit() over that.
+int ignore_bad_window(Display* display, XErrorEvent* error)
+{
+    if (error->error_code == BadWindow) return 0;
+    return previous_handler != nullptr ? previous_handler(display, error) : 0;
+}
+
+// A single 32 bit property of window (a window ID, or a PID).
+std::optional<unsigned long> get_cardinal(Display* display, Window window, Atom property,
+                                          Atom type)
+{
+    Atom actual_type{};
+    int format{};
+    unsigned long count{}, remaining{};
+    unsigned char* data = nullptr;
+
+    previous_handler = XSetErrorHandler(ignore_bad_window);
+    const auto status = XGetWindowProperty(display, window, property, 0, 1, False, type,
+                                           &actual_type, &format, &count, &remaining, &data);
+    XSetErrorHandler(previous_handler);
+
+    std::optional<unsigned long> ret;
+    if (status == Success && data != nullptr && actual_type == type && format == 32 && count == 1)
+    {
+        // Format 32 properties come back as an array of long, whatever long is.
+        ret = *reinterpret_cast<unsigned long*>(data);
+    }
+    if (data != nullptr) XFree(data);
+    return ret;
+}
+
+struct FocusFinder
+{
+    // Our own connection: SFML's is tied to its windows. Null without an X server
+    // (or XWayland), in which case there's no asking.
+    Display* display = XOpenDisplay(nullptr);
+    Atom active_window{};
+    Atom wm_pid{};
+
+    FocusFinder()
+    {
+        if (display == nullptr) return;
+        active_window = XInternAtom(display, "_NET_ACTIVE_WINDOW", False);
+        wm_pid        = XInternAtom(display, "_NET_WM_PID", False);
+    }
+    ~FocusFinder()
+    {
+        if (display != nullptr) XCloseDisplay(display);
+    }
+
+    // Nullopt if we can't tell what is focused. Otherwise, the PID of the focused
+    // window, if it has one (nothing focused, or a native Wayland window: no PID).
+    std::optional<std::optional<int>> focused_pid() const
+    {
+        if (display == nullptr) return std::nullopt;
+        // Only EWMH window managers set this. Pretty much all of them, these days.
+        const auto window =
+            get_cardinal(display, DefaultRootWindow(display), active_window, XA_WINDOW);
+        if (not window.has_value()) return std::nullopt;
+        if (*window == None) return std::optional<int>{};
+
+        const auto pid = get_cardinal(display, static_cast<Window>(*window), wm_pid, XA_CARDINAL);
+        if (not pid.has_value()) return std::optional<int>{};
+        return std::optional<int>{static_cast<int>(*pid)};
+    }
+};
+} // namespace
+
+ApplicationInfo aa::get_focused_application()
+{
+    // Unused everywhere. Skip it.
+    return {};
+}
+
+std::optional<std::string> aa::get_focused_minecraft()
+{
+    static proc::ProcessTable table;
+    static const FocusFinder focus;
+
+    // The usual case: ask X (or XWayland, which is where Minecraft runs) which
+    // window is focused, and look up just that process.
+    if (const auto focused = focus.focused_pid(); focused.has_value())
+    {
+        if (not focused->has_value()) return std::nullopt;
+        return table.instance_of(**focused);
+    }
+
+    // No X server, or a window manager that won't say. Instead: the instance that
+    // was launched last, which is the one you're playing on in most cases. Focus
+    // switches between instances aren't noticed this way.
+    table.refresh();
+    return table.newest_instance();
+}
 #else
 #error "Unsupported OS? D:"
 #endif
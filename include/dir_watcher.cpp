@@ -0,0 +1,134 @@
+#include "dir_watcher.hpp"
+
+#include "compat.hpp"
+#include "logging.hpp"
+
+#ifdef TRAACKER_LINUX_BUILD
+#include <cerrno>
+#include <cstring>
+#include <unordered_map>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/**
+ * dir_watcher.cpp
+ *
+ * Platform specific directory watching. See dir_watcher.hpp.
+ */
+
+namespace aa
+{
+#ifdef TRAACKER_LINUX_BUILD
+namespace
+{
+struct InotifyWatcher : DirectoryWatcher
+{
+    // What we care about: entries appearing/disappearing (new worlds, new
+    // advancements directories) and files being finished (saves). Minecraft
+    // either writes the file in place (close_write) or renames it over (moved_to).
+    static constexpr uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                     IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF |
+                                     IN_ONLYDIR;
+
+    explicit InotifyWatcher(int fd) : fd_(fd) {}
+    ~InotifyWatcher() override { ::close(fd_); }
+
+    bool watch(const std::string& dir) override
+    {
+        for (const auto& [_, watched] : dirs_)
+        {
+            if (watched == dir) return true;
+        }
+
+        const int wd = ::inotify_add_watch(fd_, dir.c_str(), mask);
+        if (wd < 0)
+        {
+            log::warning("Could not watch ", dir, ": ", std::strerror(errno));
+            return false;
+        }
+        dirs_[wd] = dir;
+        return true;
+    }
+
+    void unwatch(const std::string& dir) override
+    {
+        for (auto it = dirs_.begin(); it != dirs_.end(); ++it)
+        {
+            if (it->second == dir)
+            {
+                ::inotify_rm_watch(fd_, it->first);
+                dirs_.erase(it);
+                return;
+            }
+        }
+    }
+
+    void drain(std::vector<Event>& out) override
+    {
+        alignas(inotify_event) char buf[4096];
+        while (true)
+        {
+            const auto len = ::read(fd_, buf, sizeof(buf));
+            if (len <= 0)
+            {
+                // EAGAIN: we've read everything. Anything else, we'll retry next time.
+                return;
+            }
+
+            for (ssize_t i = 0; i < len;)
+            {
+                const auto* ev = reinterpret_cast<const inotify_event*>(buf + i);
+                i += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+
+                if (ev->mask & IN_Q_OVERFLOW)
+                {
+                    out.push_back(Event{"", "", true});
+                    continue;
+                }
+
+                const auto it = dirs_.find(ev->wd);
+                // Already unwatched, but the kernel had queued this before we did.
+                if (it == dirs_.end()) continue;
+
+                if (ev->mask & IN_IGNORED)
+                {
+                    // The directory itself is gone (or unmounted), so is the watch.
+                    out.push_back(Event{it->second, "", false});
+                    dirs_.erase(it);
+                    continue;
+                }
+
+                // ev->name is padded with NULs, so don't use ev->len as its size.
+                out.push_back(Event{it->second, ev->len ? std::string{ev->name} : "", false});
+            }
+        }
+    }
+
+private:
+    int fd_;
+    // Watch descriptor -> directory. A handful of entries at most.
+    std::unordered_map<int, std::string> dirs_;
+};
+} // namespace
+
+std::unique_ptr<DirectoryWatcher> DirectoryWatcher::create_native()
+{
+    const int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        log::warning("inotify is unavailable (", std::strerror(errno),
+                     "), falling back to polling.");
+        return nullptr;
+    }
+    return std::make_unique<InotifyWatcher>(fd);
+}
+#else
+std::unique_ptr<DirectoryWatcher> DirectoryWatcher::create_native()
+{
+    // No native backend here (yet). Callers poll instead.
+    return nullptr;
+}
+#endif
+} // namespace aa
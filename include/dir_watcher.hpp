@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aa
+{
+/**
+ * DirectoryWatcher - native, non-recursive directory change notifications.
+ *
+ * Only Linux (inotify) has a backend for now. create_native() returns nullptr
+ * anywhere else, or if the backend couldn't be set up, and callers are expected
+ * to fall back to polling the filesystem themselves.
+ *
+ * Nothing here blocks or spawns threads: drain() just collects whatever the
+ * kernel queued up since the last call. Call it as often as you like.
+ */
+struct DirectoryWatcher
+{
+    struct Event
+    {
+        // The watched directory, exactly as passed to watch().
+        std::string dir;
+        // The entry inside dir that changed. Empty if dir itself went away.
+        std::string name;
+        // The kernel dropped events. Anything could have changed, rescan everything.
+        bool overflow = false;
+    };
+
+    static std::unique_ptr<DirectoryWatcher> create_native();
+
+    virtual ~DirectoryWatcher() = default;
+
+    // Watches the entries of dir being created, deleted, renamed or finished
+    // being written to. Watching an already watched directory does nothing.
+    virtual bool watch(const std::string& dir) = 0;
+    virtual void unwatch(const std::string& dir) = 0;
+
+    // Appends every event since the last call to out, without blocking.
+    virtual void drain(std::vector<Event>& out) = 0;
+};
+} // namespace aa
@@ -2,6 +2,9 @@
 
 #include "logging.hpp"
 
+#include <algorithm>
+#include <filesystem>
+
 // todo - just ignore everything ever here.
 #ifndef _WIN32
 #pragma clang diagnostic push
@@ -44,16 +47,104 @@ void watch_callback(dmon_watch_id watch_id, dmon_action action, const char* root
     //    std::cout << oldfilepath << std::endl;
     //}
     // std::cout << "End of data." << std::endl;
-    if (action == DMON_ACTION_DELETE)
+    // Deletes are queued too now, it's up to the consumer to ignore them.
+    // No logging in here: the logger isn't lock free, and this is dmon's thread.
+    const auto typed = [&]
     {
-        // Ignore files that are deleted... obviously. For now. We could
-        // fix our custom callback system later to use more info, but...
-        return;
+        switch (action)
+        {
+        case DMON_ACTION_CREATE: return dmon::FileAction::Create;
+        case DMON_ACTION_DELETE: return dmon::FileAction::Delete;
+        case DMON_ACTION_MOVE: return dmon::FileAction::Move;
+        default: return dmon::FileAction::Modify;
+        }
+    }();
+
+    reinterpret_cast<dmon::impl::WatchData*>(user)->check_change(filepath, typed);
+}
+
+namespace
+{
+// Saving a file is usually several events in a row. Keep one per path, the latest.
+void coalesce_into(std::vector<dmon::FileEvent>& out, size_t first, const dmon::FileEvent& ev)
+{
+    const auto it = std::find_if(out.begin() + static_cast<ptrdiff_t>(first), out.end(),
+                                 [&](const dmon::FileEvent& e) { return e.path == ev.path; });
+    if (it == out.end())
+    {
+        out.push_back(ev);
+    }
+    else
+    {
+        it->action = ev.action;
+        it->time   = ev.time;
     }
+}
 
-    log::debug("DMON watch_callback got callback in: ", rootdir, ", with ", filepath);
+// The newest file in dir, for when we don't know what we missed.
+std::optional<std::string> newest_in(const std::string& dir)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    auto top_time = fs::file_time_type::min();
+    std::optional<std::string> top_path;
+    for (const auto& dir_entry : fs::directory_iterator{dir, ec})
+    {
+        const auto t = dir_entry.last_write_time(ec);
+        if (ec || t <= top_time) continue;
+        top_time = t;
+        top_path = dir_entry.path().string();
+    }
+    return top_path;
+}
 
-    reinterpret_cast<dmon::impl::WatchData*>(user)->check_change(filepath);
+const dmon::FileEvent* latest_change(const std::vector<dmon::FileEvent>& events)
+{
+    const dmon::FileEvent* latest = nullptr;
+    for (const auto& ev : events)
+    {
+        if (ev.action == dmon::FileAction::Delete) continue;
+        if (latest == nullptr || ev.time >= latest->time) latest = &ev;
+    }
+    return latest;
+}
+} // namespace
+
+bool dmon::Watch::drain(std::vector<FileEvent>& out)
+{
+    if (!data_)
+    {
+        log::error("No valid data_ pointer found during drain.");
+        return true;
+    }
+
+    // Read the flag first: anything dropped before this point is covered by it,
+    // anything dropped after will be reported next time.
+    const bool overflowed = data_->overflowed.exchange(false, std::memory_order_acquire);
+
+    const auto first = out.size();
+    data_->events.drain([&](FileEvent& ev) { coalesce_into(out, first, ev); });
+
+    if (overflowed)
+    {
+        get_logger("dmon::Watch").warning("Dropped events for ", dir_, ", rescanning.");
+    }
+    return not overflowed;
+}
+
+std::optional<std::string> dmon::Watch::get_change()
+{
+    std::vector<FileEvent> events;
+    if (not drain(events))
+    {
+        // We don't know what we missed, so just take whatever is newest.
+        if (not data_->file_watched.empty()) return dir_ + data_->file_watched;
+        return newest_in(dir_);
+    }
+
+    const auto* latest = latest_change(events);
+    if (latest == nullptr) return std::nullopt;
+    return dir_ + latest->path;
 }
 
 dmon::Watch::~Watch() { deactivate(); }
@@ -87,10 +178,6 @@ void dmon::Watch::set_to(std::string dirname)
         id_   = dmon_watch(dir_.c_str(), watch_callback, 0, data_.get()).id;
         return;
     }
-    else
-    {
-        std::lock_guard l(data_->change_guard);
-    }
 }
 
 void dmon::Watch::debug() const
@@ -101,7 +188,7 @@ void dmon::Watch::debug() const
     logger.debug("Do we have a valid watch? ", id_ ? "Yes" : "No");
     if (data_)
     {
-        logger.debug("Data has a modification? ", data_->has_modifications.load() ? "Yes" : "No");
+        logger.debug("Data has a modification? ", has_changes() ? "Yes" : "No");
     }
     if (id_)
     {
@@ -121,4 +208,148 @@ void dmon::Watch::deactivate()
 
 dmon::Manager::Manager() { dmon_init(); }
 dmon::Manager::~Manager() { dmon_deinit(); }
+
+// dmon has to be initialized before the first watch, and outlive the last.
+dmon::Registry::Registry() { Manager::instance(); }
+
+dmon::Registry::Handle dmon::Registry::subscribe(const std::string& root, std::string prefix)
+{
+    auto dir = root;
+    if (not dir.ends_with("/")) dir += "/";
+
+    auto root_it = std::find_if(roots_.begin(), roots_.end(),
+                                [&](const Root& r) { return r.dir == dir; });
+    if (root_it == roots_.end())
+    {
+        auto data = std::make_unique<impl::WatchData>("");
+        const auto id =
+            dmon_watch(dir.c_str(), watch_callback, DMON_WATCHFLAGS_RECURSIVE, data.get()).id;
+        get_logger("dmon::Registry").debug("Watching root: ", dir, " with ID: ", id);
+        roots_.push_back({std::move(dir), std::move(data), id});
+        root_it = roots_.end() - 1;
+    }
+
+    uint32_t slot;
+    if (not free_.empty())
+    {
+        slot = free_.back();
+        free_.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(subscribers_.size());
+        subscribers_.emplace_back();
+    }
+
+    auto& sub      = subscribers_[slot];
+    sub.live       = true;
+    sub.root       = static_cast<size_t>(root_it - roots_.begin());
+    sub.prefix     = std::move(prefix);
+    sub.overflowed = false;
+    sub.inbox.clear();
+    return {slot, sub.generation};
+}
+
+bool dmon::Registry::alive(Handle h) const noexcept
+{
+    return h.slot < subscribers_.size() && subscribers_[h.slot].live &&
+           subscribers_[h.slot].generation == h.generation;
+}
+
+bool dmon::Registry::retarget(Handle h, std::string prefix)
+{
+    if (not alive(h)) return false;
+    auto& sub = subscribers_[h.slot];
+    if (sub.prefix == prefix) return true;
+
+    // Whatever was waiting belongs to the old prefix.
+    sub.prefix = std::move(prefix);
+    sub.inbox.clear();
+    sub.overflowed = false;
+    return true;
+}
+
+void dmon::Registry::unsubscribe(Handle h)
+{
+    if (not alive(h)) return;
+    auto& sub = subscribers_[h.slot];
+    sub.live  = false;
+    sub.generation += 1;
+    sub.inbox.clear();
+    free_.push_back(h.slot);
+}
+
+void dmon::Registry::dispatch()
+{
+    for (size_t r = 0; r < roots_.size(); r++)
+    {
+        auto& root = roots_[r];
+
+        // Same order as Watch::drain: anything dropped before this read is covered.
+        const bool overflowed = root.data->overflowed.exchange(false, std::memory_order_acquire);
+        scratch_.clear();
+        root.data->events.drain([&](FileEvent& ev) { scratch_.push_back(ev); });
+
+        for (auto& sub : subscribers_)
+        {
+            if (not sub.live || sub.root != r) continue;
+            if (overflowed) sub.overflowed = true;
+
+            for (const auto& ev : scratch_)
+            {
+                if (not ev.path.starts_with(sub.prefix)) continue;
+                coalesce_into(sub.inbox, 0, FileEvent{root.dir + ev.path, ev.action, ev.time});
+            }
+        }
+    }
+}
+
+bool dmon::Registry::drain(Handle h, std::vector<FileEvent>& out)
+{
+    if (not alive(h)) return false;
+    dispatch();
+
+    auto& sub = subscribers_[h.slot];
+    const auto first = out.size();
+    for (const auto& ev : sub.inbox)
+    {
+        coalesce_into(out, first, ev);
+    }
+    sub.inbox.clear();
+    return not std::exchange(sub.overflowed, false);
+}
+
+std::optional<std::string> dmon::Registry::get_change(Handle h)
+{
+    std::vector<FileEvent> events;
+    if (not drain(h, events))
+    {
+        if (not alive(h)) return std::nullopt;
+        const auto& sub = subscribers_[h.slot];
+        get_logger("dmon::Registry").warning("Dropped events for ", sub.prefix, ", rescanning.");
+        return newest_in(roots_[sub.root].dir + sub.prefix);
+    }
+
+    const auto* latest = latest_change(events);
+    if (latest == nullptr) return std::nullopt;
+    return latest->path;
+}
+
+void dmon::Registry::debug() const
+{
+    const auto& logger = get_logger("dmon::Registry");
+    logger.debug("Roots watched: ", roots_.size(), ", subscriber slots: ", subscribers_.size(),
+                 " (", free_.size(), " free)");
+    for (const auto& root : roots_)
+    {
+        logger.debug("Root ", root.id, ": ", root.dir);
+    }
+    for (size_t i = 0; i < subscribers_.size(); i++)
+    {
+        const auto& sub = subscribers_[i];
+        if (not sub.live) continue;
+        logger.debug("Subscriber ", i, " (generation ", sub.generation, "): ",
+                     roots_[sub.root].dir, sub.prefix, ", ", sub.inbox.size(), " waiting");
+    }
+}
 } // namespace aa
\ No newline at end of file
@@ -2,14 +2,17 @@
 
 #include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <memory>
-#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "logging.hpp"
+#include "spsc_queue.hpp"
 
 // this implementation still has multiple bugs.
 // another mutex lock error (invalid argument), another
@@ -48,6 +51,22 @@ namespace dmon
 {
 using watch_id = uint32_t;
 
+enum class FileAction
+{
+    Create,
+    Delete,
+    Modify,
+    Move,
+};
+
+struct FileEvent
+{
+    // Relative to the watched directory, as dmon reports it.
+    std::string path;
+    FileAction action = FileAction::Modify;
+    std::chrono::steady_clock::time_point time{};
+};
+
 namespace impl
 {
 struct WatchData
@@ -55,23 +74,31 @@ struct WatchData
     WatchData() = default;
     WatchData(std::string watch) : file_watched(watch) {}
 
-    std::atomic<bool> has_modifications;
     std::string file_watched;
 
-    std::mutex change_guard;
-    std::string change;
+    // dmon's thread pushes, the main loop drains. Neither side ever blocks, and
+    // nothing overwrites anything: if the main loop falls 256 events behind,
+    // we flag the overflow instead, and the main loop rescans.
+    SpscQueue<FileEvent, 256> events;
+    std::atomic<bool> overflowed{false};
 
-    void check_change(std::string_view file_path)
+    void check_change(std::string_view file_path, FileAction action)
     {
-        // This is ran in a second thread. Maybe dangerous.
-        // const auto& logger = get_logger("dmon");
-        // logger.debug("Watching '", file_watched, "', found ", file_path);
+        // This is ran in a second thread. Don't log, don't lock, don't wait.
         if ((file_watched.empty() || file_path == file_watched) && not file_path.ends_with("~"))
         {
-            // logger.debug("Storing the fact that we found changes.");
-            std::lock_guard l(change_guard);
-            change = file_path;
-            has_modifications.store(true);
+            const bool pushed = events.push_with(
+                [&](FileEvent& ev)
+                {
+                    // Reuses the slot's string, so this rarely allocates.
+                    ev.path.assign(file_path);
+                    ev.action = action;
+                    ev.time   = std::chrono::steady_clock::now();
+                });
+            if (not pushed)
+            {
+                overflowed.store(true, std::memory_order_release);
+            }
         }
     }
 };
@@ -111,26 +138,18 @@ struct Watch
     bool is_active() const { return id_.has_value(); }
     bool has_changes() const
     {
-        if (data_) return data_->has_modifications.load();
+        if (data_) return not data_->events.empty() || data_->overflowed.load();
         log::error("No valid data_ pointer found during has_changes.");
         return false;
     }
 
-    std::optional<std::string> get_change()
-    {
-        if (!data_)
-        {
-            log::error("No valid data_ pointer found during get_change.");
-            return std::nullopt;
-        }
-        if (data_->has_modifications.load())
-        {
-            std::lock_guard l(data_->change_guard);
-            data_->has_modifications.store(false);
-            return dir_ + data_->change;
-        }
-        return std::nullopt;
-    }
+    // Main loop only. Appends everything that happened since the last call, one
+    // event per path (the latest one). Returns false if events were dropped, in
+    // which case the caller can't trust out and should rescan the directory.
+    bool drain(std::vector<FileEvent>& out);
+
+    // The most recently changed (not deleted) file, as a full path. Built on drain.
+    std::optional<std::string> get_change();
 
     void deactivate();
 
@@ -166,5 +185,86 @@ private:
     Manager();
     ~Manager();
 };
+
+/* Registry
+ * Given all of the above, the one thing we never want to do is unwatch. But every
+ * world switch used to do exactly that (Watch move-assign -> deactivate -> re-add).
+ *
+ * So: one recursive dmon watch per root (an instance's saves/), created the first
+ * time anybody subscribes to it and never removed. Subscribers are path prefixes
+ * under a root (e.g. "New World/advancements/"), and dispatch() routes each event
+ * to whoever's prefix matches. Switching worlds is retarget(), i.e. a string
+ * assignment: no dmon calls at all.
+ *
+ * Handles are generation tagged. Unsubscribing bumps the slot's generation, so a
+ * stale handle can't drain (or be handed) events meant for the slot's next owner.
+ *
+ * Recursive is free with FSEvents and ReadDirectoryChangesW. On Linux, dmon adds an
+ * inotify watch per subdirectory, which is one of the reasons Linux doesn't use dmon.
+ */
+struct Registry
+{
+    struct Handle
+    {
+        uint32_t slot       = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool valid() const noexcept { return slot != UINT32_MAX; }
+    };
+
+    static Registry& instance()
+    {
+        static Registry r;
+        return r;
+    }
+
+    // Events for files under root/prefix. prefix is relative to root, and may be empty.
+    Handle subscribe(const std::string& root, std::string prefix);
+    // Points h at a different prefix under the same root. False if h is stale.
+    bool retarget(Handle h, std::string prefix);
+    void unsubscribe(Handle h);
+    bool alive(Handle h) const noexcept;
+
+    // Main loop only. Moves every root's queued events to the matching subscribers.
+    void dispatch();
+
+    // Main loop only. Appends h's events (full paths, one per path) since the last
+    // call. False if h is stale, or if events were dropped and the caller should
+    // rescan. Dispatches first, so there's no need to call dispatch() separately.
+    bool drain(Handle h, std::vector<FileEvent>& out);
+    // Same idea as Watch::get_change: the newest changed (not deleted) file.
+    std::optional<std::string> get_change(Handle h);
+
+    void debug() const;
+
+private:
+    Registry();
+
+    struct Root
+    {
+        // With a trailing slash.
+        std::string dir;
+        std::unique_ptr<impl::WatchData> data;
+        watch_id id;
+    };
+
+    struct Subscriber
+    {
+        uint32_t generation = 0;
+        bool live           = false;
+        size_t root         = 0;
+        std::string prefix;
+        std::vector<FileEvent> inbox;
+        bool overflowed = false;
+    };
+
+    // Never shrinks. See above.
+    std::vector<Root> roots_;
+    std::vector<Subscriber> subscribers_;
+    // Unused subscriber slots.
+    std::vector<uint32_t> free_;
+    // Reused by dispatch().
+    std::vector<FileEvent> scratch_;
+};
 } // namespace dmon
 } // namespace aa
\ No newline at end of file
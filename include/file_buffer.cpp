@@ -0,0 +1,103 @@
+#include "file_buffer.hpp"
+
+#include "compat.hpp"
+
+#ifdef TRAACKER_WINDOWS_BUILD
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+
+#include <algorithm>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * file_buffer.cpp
+ *
+ * Platform specific whole-file reads. See file_buffer.hpp.
+ */
+
+namespace aa
+{
+#ifdef TRAACKER_WINDOWS_BUILD
+bool FileBuffer::read(const std::string& path)
+{
+    size_ = 0;
+
+    // FILE_SHARE_WRITE: Minecraft may well have the file open, don't get in its way.
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size{};
+    if (not GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    const auto expected = static_cast<size_t>(size.QuadPart);
+    if (data_.size() < expected) data_.resize(expected);
+
+    // Loop, as ReadFile takes a DWORD. The file can also shrink while we read it.
+    while (size_ < expected)
+    {
+        const auto want = static_cast<DWORD>(std::min<size_t>(expected - size_, 1u << 30));
+        DWORD got       = 0;
+        if (not ReadFile(file, data_.data() + size_, want, &got, nullptr))
+        {
+            CloseHandle(file);
+            size_ = 0;
+            return false;
+        }
+        if (got == 0) break;
+        size_ += got;
+    }
+
+    CloseHandle(file);
+    return true;
+}
+#else
+bool FileBuffer::read(const std::string& path)
+{
+    size_ = 0;
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st
+    {
+    };
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    const auto expected = static_cast<size_t>(st.st_size);
+    if (data_.size() < expected) data_.resize(expected);
+
+    // Almost always a single pread. The file can shrink while we read it, though.
+    while (size_ < expected)
+    {
+        const auto got = ::pread(fd, data_.data() + size_, expected - size_,
+                                 static_cast<off_t>(size_));
+        if (got < 0)
+        {
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        if (got == 0) break;
+        size_ += static_cast<size_t>(got);
+    }
+
+    ::close(fd);
+    return true;
+}
+#endif
+} // namespace aa
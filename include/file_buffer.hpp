@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aa
+{
+/**
+ * FileBuffer - reads an entire file into a buffer that is kept between reads.
+ *
+ * For files that someone else may be rewriting while we look at them (the
+ * player's advancements). Mapping those is asking for a SIGBUS if the game
+ * truncates the file under us, so we take a private copy with one read() call
+ * instead. Reusing the buffer means a reparse doesn't allocate once it has seen
+ * a file of that size. Files that never change (the manifest) can use MappedFile.
+ */
+struct FileBuffer
+{
+    // Replaces the contents with the file at path. False if it couldn't be read.
+    bool read(const std::string& path);
+
+    std::string_view view() const noexcept { return {data_.data(), size_}; }
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return data_.size(); }
+
+private:
+    // Never shrinks. size_ is how much of it is the current file.
+    std::vector<char> data_;
+    size_t size_ = 0;
+};
+} // namespace aa
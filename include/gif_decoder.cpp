@@ -0,0 +1,386 @@
+#include "gif_decoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+ * gif_decoder.cpp
+ *
+ * GIF87a/GIF89a, as far as anyone uses them: global and local colour tables,
+ * graphic control extensions (delay, transparency, disposal), interlacing. Plain
+ * text extensions are skipped, like everyone else does.
+ */
+
+namespace aa
+{
+namespace
+{
+// Anything bigger than this is not an icon, and not worth mapping a canvas for.
+constexpr uint64_t max_pixels = 4096 * 4096;
+
+// Interlaced images store rows 0, 8, 16.. then 4, 12.. then 2, 6.. then 1, 3..
+uint32_t interlaced_row(uint32_t row, uint32_t height)
+{
+    const auto first = (height + 7) / 8;
+    if (row < first) return row * 8;
+    row -= first;
+
+    const auto second = (height + 3) / 8;
+    if (row < second) return row * 8 + 4;
+    row -= second;
+
+    const auto third = (height + 1) / 4;
+    if (row < third) return row * 4 + 2;
+    row -= third;
+
+    return row * 2 + 1;
+}
+} // namespace
+
+uint8_t GifDecoder::byte()
+{
+    if (pos_ >= size_)
+    {
+        broken_ = true;
+        return 0;
+    }
+    return data_[pos_++];
+}
+
+uint16_t GifDecoder::word()
+{
+    const uint16_t lo = byte();
+    return static_cast<uint16_t>(lo | (byte() << 8));
+}
+
+void GifDecoder::skip_sub_blocks()
+{
+    for (auto length = byte(); length != 0 && not broken_; length = byte())
+    {
+        pos_ += length;
+    }
+}
+
+bool GifDecoder::open(const std::string& path)
+{
+    file_  = MappedFile{path};
+    start_ = 0;
+    if (not file_.valid()) return false;
+
+    data_   = reinterpret_cast<const uint8_t*>(file_.data());
+    size_   = file_.size();
+    pos_    = 0;
+    broken_ = false;
+    if (size_ < 13 || std::memcmp(data_, "GIF8", 4) != 0 ||
+        (data_[4] != '7' && data_[4] != '9') || data_[5] != 'a')
+    {
+        return false;
+    }
+
+    // Logical screen descriptor. Background colour and aspect ratio are ignored.
+    pos_              = 6;
+    width_            = word();
+    height_           = word();
+    const auto packed = byte();
+    pos_ += 2;
+
+    global_palette_ = nullptr;
+    global_colours_ = 0;
+    if (packed & 0x80)
+    {
+        global_colours_ = size_t{2} << (packed & 7);
+        global_palette_ = data_ + pos_;
+        pos_ += global_colours_ * 3;
+    }
+
+    if (pos_ > size_ || width_ == 0 || height_ == 0 ||
+        uint64_t{width_} * height_ > max_pixels)
+    {
+        return false;
+    }
+
+    start_ = pos_;
+    canvas_.assign(size_t{width_} * height_ * 4, 0);
+    rewind();
+    return true;
+}
+
+void GifDecoder::rewind()
+{
+    pos_      = start_;
+    broken_   = false;
+    frame_    = none;
+    delay_ms_ = 0;
+    disposal_ = 0;
+    std::fill(canvas_.begin(), canvas_.end(), uint8_t{0});
+}
+
+bool GifDecoder::next()
+{
+    if (not valid() || broken_) return false;
+
+    // Whatever the graphic control extension says applies to the next image only.
+    uint8_t disposal = 0;
+    uint32_t delay   = 0;
+    int transparent  = -1;
+
+    while (true)
+    {
+        const auto introducer = byte();
+        if (broken_) return false;
+
+        if (introducer == 0x3B)
+        {
+            // Trailer. Stay here, so that every next() after this is false too.
+            pos_ -= 1;
+            return false;
+        }
+
+        if (introducer == 0x21)
+        {
+            if (byte() == 0xF9)
+            {
+                const auto length = byte();
+                const auto block  = pos_;
+                const auto packed = byte();
+                delay             = word() * 10u;
+                const auto index  = byte();
+                disposal          = (packed >> 2) & 7;
+                if (packed & 1) transparent = index;
+                pos_ = block + length;
+            }
+            // Graphic control extensions end with an empty sub-block too.
+            skip_sub_blocks();
+            continue;
+        }
+
+        if (introducer != 0x2C)
+        {
+            broken_ = true;
+            return false;
+        }
+
+        Rect rect;
+        rect.x            = word();
+        rect.y            = word();
+        rect.w            = word();
+        rect.h            = word();
+        const auto packed = byte();
+
+        auto* palette  = global_palette_;
+        size_t colours = global_colours_;
+        if (packed & 0x80)
+        {
+            colours = size_t{2} << (packed & 7);
+            palette = data_ + pos_;
+            pos_ += colours * 3;
+        }
+        if (broken_ || pos_ > size_)
+        {
+            broken_ = true;
+            return false;
+        }
+
+        dispose();
+        if (disposal == 3) previous_ = canvas_;
+
+        // A frame that stops half way is still shown (as far as it got), but it's
+        // the last one.
+        if (not decode_image(rect, packed & 0x40, palette, colours, transparent))
+        {
+            broken_ = true;
+        }
+
+        frame_     = frame_ == none ? 0 : frame_ + 1;
+        delay_ms_  = delay;
+        disposal_  = disposal;
+        last_rect_ = rect;
+        return true;
+    }
+}
+
+void GifDecoder::dispose()
+{
+    if (frame_ == none) return;
+
+    if (disposal_ == 2)
+    {
+        // Restore to background, which is transparent for us.
+        const auto x1 = std::min(last_rect_.x + last_rect_.w, width_);
+        const auto y1 = std::min(last_rect_.y + last_rect_.h, height_);
+        for (auto y = last_rect_.y; y < y1; y++)
+        {
+            if (last_rect_.x >= x1) break;
+            auto* row = canvas_.data() + (size_t{y} * width_ + last_rect_.x) * 4;
+            std::fill(row, row + size_t{x1 - last_rect_.x} * 4, uint8_t{0});
+        }
+    }
+    else if (disposal_ == 3 && previous_.size() == canvas_.size())
+    {
+        std::copy(previous_.begin(), previous_.end(), canvas_.begin());
+    }
+}
+
+bool GifDecoder::decode_image(const Rect& rect, bool interlaced, const uint8_t* palette,
+                              size_t colours, int transparent)
+{
+    const auto min_size = byte();
+    if (broken_ || min_size < 1 || min_size > 11)
+    {
+        skip_sub_blocks();
+        return false;
+    }
+
+    const size_t total = size_t{rect.w} * rect.h;
+    indices_.resize(total);
+    size_t written = 0;
+
+    // Codes are packed LSB first, across however many sub-blocks.
+    size_t block_left = 0;
+    bool blocks_done  = false;
+    uint32_t bits     = 0;
+    uint32_t count    = 0;
+    const auto next_byte = [&]() -> int
+    {
+        if (block_left == 0)
+        {
+            block_left = byte();
+            if (block_left == 0 || broken_)
+            {
+                blocks_done = true;
+                return -1;
+            }
+        }
+        block_left -= 1;
+        // Cut off in the middle of a sub-block: that's as far as the image goes.
+        const auto b = byte();
+        if (broken_)
+        {
+            blocks_done = true;
+            return -1;
+        }
+        return b;
+    };
+
+    const uint32_t clear = 1u << min_size;
+    const uint32_t eoi   = clear + 1;
+    for (uint32_t i = 0; i < clear; i++)
+    {
+        suffix_[i] = static_cast<uint8_t>(i);
+    }
+
+    uint32_t code_size = min_size + 1;
+    uint32_t next_code = eoi + 1;
+    int old            = -1;
+    uint8_t first      = 0;
+    bool ok            = true;
+
+    while (written < total)
+    {
+        while (count < code_size)
+        {
+            const auto b = next_byte();
+            if (b < 0) break;
+            bits |= static_cast<uint32_t>(b) << count;
+            count += 8;
+        }
+        if (count < code_size)
+        {
+            // Ran out of data before the image was complete.
+            ok = false;
+            break;
+        }
+
+        auto code = bits & ((1u << code_size) - 1);
+        bits >>= code_size;
+        count -= code_size;
+
+        if (code == clear)
+        {
+            code_size = min_size + 1;
+            next_code = eoi + 1;
+            old       = -1;
+            continue;
+        }
+        if (code == eoi) break;
+
+        if (old < 0)
+        {
+            if (code >= clear)
+            {
+                ok = false;
+                break;
+            }
+            first               = static_cast<uint8_t>(code);
+            indices_[written++] = first;
+            old                 = static_cast<int>(code);
+            continue;
+        }
+
+        const auto in = code;
+        size_t depth  = 0;
+        if (code >= next_code)
+        {
+            // The one code that may not be in the dictionary yet: old + its first byte.
+            if (code > next_code)
+            {
+                ok = false;
+                break;
+            }
+            stack_[depth++] = first;
+            code            = static_cast<uint32_t>(old);
+        }
+        while (code >= clear)
+        {
+            stack_[depth++] = suffix_[code];
+            code            = prefix_[code];
+        }
+        first           = suffix_[code];
+        stack_[depth++] = first;
+
+        while (depth > 0 && written < total)
+        {
+            indices_[written++] = stack_[--depth];
+        }
+
+        if (next_code < 4096)
+        {
+            prefix_[next_code] = static_cast<uint16_t>(old);
+            suffix_[next_code] = first;
+            next_code += 1;
+            if (next_code == (1u << code_size) && code_size < 12) code_size += 1;
+        }
+        old = static_cast<int>(in);
+    }
+
+    // Past whatever is left of the image data (usually just the terminator).
+    if (not blocks_done)
+    {
+        pos_ += block_left;
+        skip_sub_blocks();
+    }
+
+    // Onto the canvas, as far as we got. Clipped, frames may stick out of it.
+    for (size_t i = 0; i < written; i += rect.w)
+    {
+        const auto row = static_cast<uint32_t>(i / rect.w);
+        const auto y   = rect.y + (interlaced ? interlaced_row(row, rect.h) : row);
+        if (y >= height_) continue;
+
+        const auto end = std::min<size_t>(rect.w, written - i);
+        auto* dst      = canvas_.data() + size_t{y} * width_ * 4;
+        for (size_t col = 0; col < end && rect.x + col < width_; col++)
+        {
+            const auto index = indices_[i + col];
+            if (static_cast<int>(index) == transparent || index >= colours) continue;
+            const auto* rgb = palette + size_t{index} * 3;
+            auto* px        = dst + (rect.x + col) * 4;
+            px[0]           = rgb[0];
+            px[1]           = rgb[1];
+            px[2]           = rgb[2];
+            px[3]           = 255;
+        }
+    }
+    return ok && not broken_;
+}
+} // namespace aa
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "mapped_file.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aa
+{
+/**
+ * GifDecoder - decodes an animated GIF one frame at a time.
+ *
+ * The file is mapped, not read, and nothing is decoded until next() is called,
+ * which decodes exactly one more frame and composites it onto the canvas (taking
+ * the previous frame's disposal into account). So memory is the canvas (plus a
+ * copy of it for "restore to previous" frames) no matter how long the animation
+ * is. Playing it again means rewind().
+ *
+ * Transparent pixels and "restore to background" are both fully transparent,
+ * like browsers do it, rather than the background colour.
+ */
+struct GifDecoder
+{
+    static constexpr size_t none = static_cast<size_t>(-1);
+
+    // Parses the header. False if the file couldn't be read or isn't a GIF.
+    bool open(const std::string& path);
+
+    // Decodes the next frame onto the canvas. False at the end of the file, or if
+    // the rest of it is broken (whatever decoded fine so far is still good).
+    bool next();
+
+    // Back to before the first frame. Cheap.
+    void rewind();
+
+    bool valid() const noexcept { return file_.valid() && start_ != 0; }
+    uint32_t width() const noexcept { return width_; }
+    uint32_t height() const noexcept { return height_; }
+
+    // width x height, RGBA, row major. The frame next() just decoded.
+    const std::vector<uint8_t>& canvas() const noexcept { return canvas_; }
+    // Index of the frame on the canvas, none before the first next().
+    size_t frame() const noexcept { return frame_; }
+    // How long that frame is shown, as written in the file. 0 is common, and
+    // means "whatever the viewer thinks is sensible".
+    uint32_t delay_ms() const noexcept { return delay_ms_; }
+
+private:
+    struct Rect
+    {
+        uint32_t x = 0, y = 0, w = 0, h = 0;
+    };
+
+    // Bounds checked reads at pos_. Anything past the end reads as 0, and sets
+    // broken_, so that callers only need to check once per block.
+    uint8_t byte();
+    uint16_t word();
+    void skip_sub_blocks();
+
+    // The LZW-compressed image data at pos_, into rect of the canvas.
+    bool decode_image(const Rect& rect, bool interlaced, const uint8_t* palette,
+                      size_t colours, int transparent);
+    void dispose();
+
+    MappedFile file_;
+    const uint8_t* data_ = nullptr;
+    size_t size_         = 0;
+    size_t pos_          = 0;
+    // Truncated, or garbage. Nothing more is decoded until rewind().
+    bool broken_ = false;
+    // Where the first block after the header (and global colour table) is.
+    size_t start_ = 0;
+
+    uint32_t width_  = 0;
+    uint32_t height_ = 0;
+    const uint8_t* global_palette_ = nullptr;
+    size_t global_colours_         = 0;
+
+    std::vector<uint8_t> canvas_;
+    // The canvas before the last frame, if that one is to be restored afterwards.
+    std::vector<uint8_t> previous_;
+    size_t frame_      = none;
+    uint32_t delay_ms_ = 0;
+
+    // What to do with the last frame before drawing the next one.
+    uint8_t disposal_ = 0;
+    Rect last_rect_;
+
+    // Reused between frames. One palette index per pixel, and the LZW dictionary.
+    std::vector<uint8_t> indices_;
+    std::array<uint16_t, 4096> prefix_{};
+    std::array<uint8_t, 4096> suffix_{};
+    std::array<uint8_t, 4097> stack_{};
+};
+} // namespace aa
@@ -0,0 +1,188 @@
+#include "ProcessTable.hpp"
+
+#include "app_finder.hpp"
+#include "logging.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace proc {
+namespace {
+std::optional<std::string> read_whole(const std::string& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (not f.good()) return std::nullopt;
+    return std::string{std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{}};
+}
+
+std::optional<int> parse_pid(std::string_view name)
+{
+    int pid = 0;
+    const auto [ptr, ec] = std::from_chars(name.data(), name.data() + name.size(), pid);
+    if (ec != std::errc{} || ptr != name.data() + name.size()) return std::nullopt;
+    return pid;
+}
+} // namespace
+
+std::optional<std::string> instance_from_cmdline(std::string_view cmdline)
+{
+    constexpr std::string_view inst_str = "/instances/";
+
+    // One argument at a time. No quoting to worry about, unlike on Windows.
+    while (not cmdline.empty())
+    {
+        const auto end = cmdline.find('\0');
+        const auto arg = cmdline.substr(0, end);
+        cmdline        = end == std::string_view::npos ? "" : cmdline.substr(end + 1);
+
+        if (not arg.starts_with(aa::MMC_LIB_PATH_PREFIX)) continue;
+
+        const auto path = arg.substr(aa::MMC_LIB_PATH_PREFIX.size());
+        const auto pos  = path.rfind(inst_str);
+        if (pos == std::string_view::npos)
+        {
+            aa::get_logger("ProcessTable")
+                .warning("Could not find instances path: no /instances/.");
+            return std::nullopt;
+        }
+        // Everything up to (not including) the slash after the instance name.
+        return std::string{path.substr(0, path.find('/', pos + inst_str.size()))};
+    }
+    return std::nullopt;
+}
+
+ProcessTable::ProcessTable(std::string proc_root, uint32_t recheck_every)
+    : root_(std::move(proc_root)), recheck_every_(std::max(recheck_every, uint32_t{1}))
+{
+}
+
+std::optional<ProcessTable::Process> ProcessTable::read_stat(int pid) const
+{
+    const auto stat = read_whole(root_ + "/" + std::to_string(pid) + "/stat");
+    if (not stat.has_value()) return std::nullopt;
+
+    // pid (comm) state ppid ... - comm can contain spaces and parentheses, so
+    // start counting fields after the LAST ')'. starttime is field 22; the one
+    // right after the ')' is field 3.
+    const auto open = stat->find('(');
+    auto pos        = stat->rfind(')');
+    if (open == std::string::npos || pos == std::string::npos || pos < open) return std::nullopt;
+    Process ret{0, stat->substr(open + 1, pos - open - 1), false, std::nullopt};
+    for (int field = 2; field < 22; field++)
+    {
+        pos = stat->find(' ', pos + 1);
+        if (pos == std::string::npos) return std::nullopt;
+    }
+
+    const auto* first    = stat->data() + pos + 1;
+    const auto [ptr, ec] = std::from_chars(first, stat->data() + stat->size(), ret.start_time);
+    if (ec != std::errc{}) return std::nullopt;
+    return ret;
+}
+
+void ProcessTable::read_cmdline(int pid, Process& process) const
+{
+    // Kernel threads and processes we can't look at have an empty/unreadable cmdline.
+    // That's fine, they aren't Minecraft either.
+    process.java = false;
+    process.instance.reset();
+    if (const auto cmdline = read_whole(root_ + "/" + std::to_string(pid) + "/cmdline");
+        cmdline.has_value())
+    {
+        const auto exe = std::string_view{*cmdline}.substr(0, cmdline->find('\0'));
+        process.java   = exe.find("java") != std::string_view::npos;
+        if (process.java)
+        {
+            process.instance = instance_from_cmdline(*cmdline);
+        }
+    }
+}
+
+void ProcessTable::refresh()
+{
+    namespace fs = std::filesystem;
+
+    listed_.clear();
+    std::error_code ec;
+    for (const auto& dir_entry : fs::directory_iterator{root_, ec})
+    {
+        if (const auto pid = parse_pid(dir_entry.path().filename().native()); pid.has_value())
+        {
+            listed_.push_back(*pid);
+        }
+    }
+    if (ec)
+    {
+        aa::get_logger("ProcessTable").debug("Could not list ", root_, ": ", ec.message());
+        return;
+    }
+
+    // Forget whatever exited.
+    std::sort(listed_.begin(), listed_.end());
+    std::erase_if(processes_, [&](const auto& kv)
+                  { return not std::binary_search(listed_.begin(), listed_.end(), kv.first); });
+
+    refreshes_ += 1;
+    for (const auto pid : listed_)
+    {
+        const auto it = processes_.find(pid);
+        if (it != processes_.end() && not it->second.java &&
+            (static_cast<uint64_t>(pid) + refreshes_) % recheck_every_ != 0)
+        {
+            // Known not to be Java. Its turn to be checked again comes later.
+            continue;
+        }
+        update(pid);
+    }
+}
+
+void ProcessTable::update(int pid)
+{
+    auto process  = read_stat(pid);
+    const auto it = processes_.find(pid);
+    if (not process.has_value())
+    {
+        // Exited between listing and reading.
+        if (it != processes_.end()) processes_.erase(it);
+        return;
+    }
+
+    if (it != processes_.end() && it->second.start_time == process->start_time &&
+        it->second.comm == process->comm)
+    {
+        // Same process, same executable. Its cmdline hasn't changed either.
+        return;
+    }
+
+    read_cmdline(pid, *process);
+    if (process->instance.has_value())
+    {
+        aa::get_logger("ProcessTable")
+            .debug("Found Minecraft (", pid, ") for instance: ", *process->instance);
+    }
+    processes_.insert_or_assign(pid, std::move(*process));
+}
+
+std::optional<std::string> ProcessTable::instance_of(int pid)
+{
+    update(pid);
+    const auto it = processes_.find(pid);
+    if (it == processes_.end()) return std::nullopt;
+    return it->second.instance;
+}
+
+std::optional<std::string> ProcessTable::newest_instance() const
+{
+    const Process* newest = nullptr;
+    for (const auto& [_, process] : processes_)
+    {
+        if (not process.instance.has_value()) continue;
+        if (newest == nullptr || process.start_time > newest->start_time) newest = &process;
+    }
+    if (newest == nullptr) return std::nullopt;
+    return newest->instance;
+}
+} // namespace proc
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace proc {
+// Pulls the instance directory out of a MultiMC/Prism launched JVM's command line
+// (NUL separated, as in /proc/<pid>/cmdline), e.g.
+// -Djava.library.path=/home/me/.local/share/PrismLauncher/instances/AA/natives
+// -> /home/me/.local/share/PrismLauncher/instances/AA
+std::optional<std::string> instance_from_cmdline(std::string_view cmdline);
+
+/**
+ * ProcessTable - a cache of which running processes are Minecraft instances.
+ *
+ * /proc has an entry per process, and reading every cmdline every poll adds up
+ * (that reads the other process's memory). refresh() lists /proc and reads the
+ * small stat file of the PIDs that could matter, and only reads cmdline when
+ * that says something changed: a PID we haven't seen, a different start time
+ * (the PID got reused), or a different comm (the process exec'd, e.g.
+ * gamemoderun or a launcher wrapper script turning into java - same PID, same
+ * start time). PIDs that are gone are forgotten.
+ *
+ * Everything that isn't Java (nearly everything) is only re-stat'ed every
+ * recheck_every refreshes, staggered by PID, so one refresh costs a directory
+ * listing plus a handful of stats. A non-Java PID that execs Java (or gets
+ * reused by a Java process) is noticed within recheck_every refreshes.
+ *
+ * The /proc root is a constructor argument so that a fake tree works too.
+ */
+struct ProcessTable
+{
+    struct Process
+    {
+        // In clock ticks since boot, from /proc/<pid>/stat. Bigger == newer.
+        uint64_t start_time = 0;
+        // Executable name (truncated to 15 characters by the kernel). Changes on exec.
+        std::string comm;
+        // The executable is a JVM. Everything else is only checked now and then.
+        bool java = false;
+        // Only set for Minecraft instances.
+        std::optional<std::string> instance;
+    };
+
+    explicit ProcessTable(std::string proc_root = "/proc", uint32_t recheck_every = 8);
+
+    void refresh();
+
+    // The most recently started Minecraft instance, if any are running.
+    std::optional<std::string> newest_instance() const;
+
+    // The instance pid belongs to, if it is a Minecraft instance. Only reads
+    // that PID (its stat, and its cmdline if it isn't the process we cached),
+    // no refresh() needed.
+    std::optional<std::string> instance_of(int pid);
+
+    const std::unordered_map<int, Process>& processes() const noexcept { return processes_; }
+
+private:
+    // start_time and comm only.
+    std::optional<Process> read_stat(int pid) const;
+    // Fills in java, and instance if the cmdline says it's Minecraft.
+    void read_cmdline(int pid, Process& process) const;
+    // Re-reads pid if its stat says it isn't the process we have cached.
+    void update(int pid);
+
+    std::string root_;
+    uint32_t recheck_every_;
+    uint64_t refreshes_ = 0;
+    std::unordered_map<int, Process> processes_;
+    // Reused between refreshes.
+    std::vector<int> listed_;
+};
+} // namespace proc
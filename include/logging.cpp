@@ -1,5 +1,7 @@
 #include "logging.hpp"
 
+#include <mutex>
+
 namespace aa {
 bool Logger::stdout_default = false;
 LogLevel Logger::level      = LogLevel::Debug;
@@ -10,6 +12,12 @@ string_map<std::unique_ptr<std::ofstream>>& detail::get_files()
     return files;
 }
 
+std::mutex& detail::write_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
 std::ofstream* get_file(std::string_view name)
 {
     // Ugh, these are not safe, because of realloc.
@@ -53,6 +61,9 @@ std::ofstream* get_file(std::string_view name)
 Logger& get_logger(std::string_view name)
 {
     static string_map<Logger> loggers;
+    // Parsing happens on a worker thread too (see StatusParser).
+    static std::mutex mutex;
+    std::lock_guard lock{mutex};
 
     if (not loggers.contains(name))
     {
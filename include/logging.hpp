@@ -10,6 +10,7 @@
 #include "utilities.hpp"
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <optional>
 #include <sstream>
 
@@ -19,6 +20,8 @@ namespace aa
 namespace detail
 {
 string_map<std::unique_ptr<std::ofstream>>& get_files();
+// Held for each whole line, so that lines from different threads don't interleave.
+std::mutex& write_mutex();
 }
 std::ofstream* get_file(std::string_view name);
 
@@ -161,6 +164,8 @@ private:
     template <typename... Ts>
     void write_endl(Ts&&... ts) const
     {
+        // Parsing logs from a worker thread too (see StatusParser).
+        std::lock_guard lock{detail::write_mutex()};
         write(std::forward<Ts>(ts)...);
         // Doesn't work, not sure why, no google atm...
         // write(std::endl);
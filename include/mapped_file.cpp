@@ -0,0 +1,111 @@
+#include "mapped_file.hpp"
+
+#include "compat.hpp"
+
+#ifdef TRAACKER_WINDOWS_BUILD
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * mapped_file.cpp
+ *
+ * Platform specific file mapping. See mapped_file.hpp.
+ */
+
+namespace aa
+{
+#ifdef TRAACKER_WINDOWS_BUILD
+MappedFile::MappedFile(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    LARGE_INTEGER size{};
+    if (not GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    size_  = static_cast<size_t>(size.QuadPart);
+    valid_ = true;
+    if (size_ == 0)
+    {
+        // Can't map an empty file. That's fine, there's nothing in it anyways.
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // The mapping keeps the file alive.
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        size_  = 0;
+        valid_ = false;
+        return;
+    }
+
+    data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr)
+    {
+        CloseHandle(mapping);
+        size_  = 0;
+        valid_ = false;
+        return;
+    }
+    handle_ = mapping;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_) UnmapViewOfFile(data_);
+    if (handle_) CloseHandle(static_cast<HANDLE>(handle_));
+}
+#else
+MappedFile::MappedFile(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st
+    {
+    };
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return;
+    }
+
+    size_  = static_cast<size_t>(st.st_size);
+    valid_ = true;
+    if (size_ > 0)
+    {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            size_  = 0;
+            valid_ = false;
+        }
+        else
+        {
+            data_ = static_cast<const char*>(p);
+        }
+    }
+
+    // The mapping keeps the file alive.
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+}
+#endif
+} // namespace aa
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace aa
+{
+/**
+ * MappedFile - a read-only memory mapping of an entire file.
+ *
+ * mmap on POSIX, MapViewOfFile on Windows. The contents are only valid for as
+ * long as the MappedFile lives. Empty files are valid, but have an empty view.
+ */
+struct MappedFile
+{
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { swap(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        MappedFile tmp{std::move(other)};
+        swap(tmp);
+        return *this;
+    }
+
+    // Did we manage to open (and map) the file?
+    bool valid() const noexcept { return valid_; }
+    size_t size() const noexcept { return size_; }
+    const char* data() const noexcept { return data_; }
+    std::string_view view() const noexcept { return {data_, size_}; }
+
+private:
+    void swap(MappedFile& other) noexcept
+    {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(valid_, other.valid_);
+        std::swap(handle_, other.handle_);
+    }
+
+    const char* data_ = nullptr;
+    size_t size_      = 0;
+    bool valid_       = false;
+    // Windows only - the file mapping object. Unused elsewhere.
+    void* handle_ = nullptr;
+};
+} // namespace aa
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace aa
+{
+/**
+ * SpscQueue - bounded, lock-free, single producer / single consumer queue.
+ *
+ * One thread pushes, one (other) thread pops, neither ever waits for the other.
+ * Slots are reused rather than constructed/destroyed, so a T that owns memory
+ * (e.g. a std::string) keeps its capacity between uses.
+ *
+ * head_ is only written by the consumer, tail_ only by the producer. Each side
+ * publishes its progress with a release store, and reads the other side's with
+ * an acquire load, which is all the synchronization the slots need.
+ */
+template <typename T, size_t Capacity>
+struct SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two.");
+
+    // Producer only. fill(T&) writes the new element in place.
+    // Returns false (and doesn't call fill) if the queue is full.
+    template <typename F>
+    bool push_with(F&& fill)
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+        fill(slots_[tail & (Capacity - 1)]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Calls f(T&) for everything queued right now, oldest first.
+    // Returns how many elements were consumed.
+    template <typename F>
+    size_t drain(F&& f)
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        const auto tail = tail_.load(std::memory_order_acquire);
+        for (auto i = head; i != tail; i++)
+        {
+            f(slots_[i & (Capacity - 1)]);
+        }
+        head_.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+    // Only a snapshot, of course.
+    bool empty() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() noexcept { return Capacity; }
+
+private:
+    // 64 rather than hardware_destructive_interference_size, which is not
+    // available everywhere and warns about ABI stability where it is.
+    static constexpr size_t cache_line = 64;
+
+    std::array<T, Capacity> slots_{};
+    // Kept on separate cache lines, so the two threads don't fight over them.
+    alignas(cache_line) std::atomic<size_t> head_{0};
+    alignas(cache_line) std::atomic<size_t> tail_{0};
+};
+} // namespace aa
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <string_view>
 #include <type_traits>
@@ -46,4 +47,16 @@ auto apply(const auto& js, auto key, F&& operation) -> void
     {
         operation(js[key]);
     }
-}
\ No newline at end of file
+}
+
+// FNV-1a (64 bit). Not cryptographic, just a quick fingerprint for
+// "did this file change". Chain calls by passing the previous hash back in.
+constexpr uint64_t fnv1a(std::string_view data, uint64_t hash = 14695981039346656037ull) noexcept
+{
+    for (const auto c : data)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -3,6 +3,10 @@
 #include "logging.hpp"
 
 #include "ResourceManager.hpp"
+#include "file_buffer.hpp"
+#include "mapped_file.hpp"
+
+#include <cassert>
 
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
@@ -75,15 +79,17 @@ AdvancementManifest::from_file(std::string_view filename /* advancements.json */
 
     logger.debug("Loading core advancement manifest from file: ", filename);
 
-    std::ifstream f(filename.data() /* msvc */);
-    if (!f.good())
+    // The manifest never changes under us, so just map it.
+    const MappedFile f{std::string{filename}};
+    if (not f.valid())
     {
         logger.error("Failed to load core advancement manifest from file: ", filename);
         throw std::runtime_error("No advancements manifest (json) found / loadable!");
     }
 
     logger.debug("Parsing manifest JSON.");
-    auto advancements = json::parse(f);
+    const auto contents = f.view();
+    auto advancements   = json::parse(contents.begin(), contents.end());
 
     // We load all assets here, during manifest creation.
     // Generally, we only create one manifest. However, we can create more, not sure
@@ -91,7 +97,7 @@ AdvancementManifest::from_file(std::string_view filename /* advancements.json */
     auto& rm = aa::ResourceManager::instance();
 
     logger.debug("Loading map of available assets.");
-    auto assets = aa::ResourceManager::getAllAssets();
+    const auto& assets = aa::ResourceManager::getAllAssets();
     for (auto& [k, v] : assets)
     {
         logger.debug("Asset named ", k, " located at ", v);
@@ -126,13 +132,14 @@ AdvancementManifest::from_file(std::string_view filename /* advancements.json */
                          " short name: ", short_name);
             // "minecraft:adventure/two_birds_one_arrow"
             // -> ["adventure/two_birds_one_arrow", "two_birds_one_arrow"]
-            auto [itr, success] = ret.advancements.emplace(
-                id.full_id, Advancement{id.icon, id.category, pretty_name, short_name});
-            if (!success)
+            auto* inserted =
+                ret.add_advancement(Advancement{id.icon, id.category, pretty_name, short_name});
+            if (inserted == nullptr)
             {
                 logger.warning("Failed to insert advancement: ", id.full_id);
+                continue;
             }
-            auto& adv = itr->second;
+            auto& adv = *inserted;
 
             // Load all criteria.
             if (a.contains("criteria"))
@@ -159,10 +166,10 @@ AdvancementManifest::from_file(std::string_view filename /* advancements.json */
                             logger.fatal_error("Could not find criteria texture for: ", icon,
                                                " (In advancement: ", adv.full_id(), ")");
                         }
-                        adv.add_criteria(crit, rm.criteria_map[crit].get());
+                        ret.add_criterion(adv, crit, crit, rm.criteria_map[crit]);
                         continue;
                     }
-                    adv.add_criteria(crit, rm.criteria_map[icon].get());
+                    ret.add_criterion(adv, crit, icon, rm.criteria_map[icon]);
                 }
             }
 
@@ -177,9 +184,10 @@ AdvancementManifest::from_file(std::string_view filename /* advancements.json */
                                        adv.full_id(), ")");
                 }
 
-                adv.icon = rm.store_texture_at(assets[explicit_icon]);
+                adv.icon_path = assets.at(explicit_icon);
+                adv.icon      = rm.icon_at(adv.icon_path);
                 logger.debug("Loaded explicit icon for ", adv.name,
-                             " from file: ", assets[explicit_icon]);
+                             " from file: ", assets.at(explicit_icon));
 
                 continue;
             }
@@ -187,9 +195,10 @@ AdvancementManifest::from_file(std::string_view filename /* advancements.json */
             // Load IMPLICIT icon.
             if (assets.contains(adv.name))
             {
-                adv.icon = rm.store_texture_at(assets[adv.name]);
+                adv.icon_path = assets.at(adv.name);
+                adv.icon      = rm.icon_at(adv.icon_path);
                 logger.debug("Loaded implicit icon for ", adv.name,
-                             " from file: ", assets[adv.name]);
+                             " from file: ", assets.at(adv.name));
 
                 continue;
             }
@@ -199,31 +208,322 @@ AdvancementManifest::from_file(std::string_view filename /* advancements.json */
         }
     }
 
-    logger.info("Loaded ", ret.advancements.size(), " advancements from: ", filename);
+    logger.info("Loaded ", ret.advancements.size(), " advancements and ", ret.criteria.size(),
+                " criteria from: ", filename);
 
     return ret;
 }
 
+Advancement* AdvancementManifest::add_advancement(Advancement adv)
+{
+    const auto ordinal = static_cast<uint32_t>(advancements.size());
+    if (not ordinals.emplace(adv.full_id(), ordinal).second)
+    {
+        return nullptr;
+    }
+
+    adv.ordinal        = ordinal;
+    adv.criteria_begin = static_cast<uint32_t>(criteria.size());
+    adv.criteria_end   = adv.criteria_begin;
+    return &advancements.emplace_back(std::move(adv));
+}
+
+Criterion* AdvancementManifest::add_criterion(Advancement& adv, std::string key,
+                                              std::string icon_name, Icon icon)
+{
+    // Keeps every advancement's criteria contiguous.
+    assert(adv.ordinal + 1 == advancements.size());
+    assert(adv.criteria_end == criteria.size());
+
+    const auto ordinal = static_cast<uint32_t>(criteria.size());
+    if (not adv.criteria.emplace(key, ordinal).second)
+    {
+        get_logger("AdvancementManifest").warning("Duplicate criterion ", key, " in ",
+                                                  adv.full_id());
+        return nullptr;
+    }
+    adv.criteria_end += 1;
+    return &criteria.emplace_back(
+        Criterion{std::move(key), std::move(icon_name), icon, ordinal, adv.ordinal});
+}
+
+namespace status
+{
+// This namespace groups parsers that act on the player's advancements file,
+// i.e. saves/<world>/advancements/<uuid>.json.
+//
+// StatusSaxHandler - fills an AdvancementStatus directly from SAX events.
+// The player file is mostly recipe advancements (847 of the ~930 entries in
+// testing/all-everything.json), and we don't care about any of them. Building
+// a full DOM just to throw most of it away is silly, so instead we skip any
+// subtree we don't care about without ever materializing it.
+//
+// The file looks like this:
+// {
+//   "minecraft:adventure/adventuring_time": {   <- depth 1 key
+//     "criteria": {                             <- depth 2 key
+//       "minecraft:plains": "2023-08-16 ...",   <- depth 3 key
+//       ...
+//     },
+//     "done": false
+//   },
+//   "minecraft:recipes/...": { ... },           <- skipped entirely
+//   "DataVersion": 2567                         <- skipped
+// }
+struct StatusSaxHandler
+{
+    StatusSaxHandler(AdvancementStatus& status, const Logger& logger)
+        : ret(status), logger(logger)
+    {
+    }
+
+    AdvancementStatus& ret;
+    const Logger& logger;
+
+    // How many objects deep we are (ignoring skipped subtrees). 1 == top level.
+    size_t depth = 0;
+    // Number of containers we are nested into while skipping a value.
+    size_t skip_level = 0;
+    // Set when the next value (scalar or container) should be ignored.
+    bool skip_next = false;
+
+    enum class Field
+    {
+        None,
+        Done,
+        Criteria,
+    } field = Field::None;
+
+    // The advancement we are currently inside of (depth >= 2).
+    const Advancement* current = nullptr;
+    bool current_done          = false;
+
+    bool skipping() const noexcept { return skip_level > 0; }
+
+    // Returns true if this scalar should be ignored.
+    bool consume_scalar() noexcept
+    {
+        if (skipping()) return true;
+        if (skip_next)
+        {
+            skip_next = false;
+            return true;
+        }
+        return false;
+    }
+
+    // Returns true if this container should be ignored.
+    bool consume_container() noexcept
+    {
+        if (skipping() || skip_next)
+        {
+            skip_next = false;
+            ++skip_level;
+            return true;
+        }
+        return false;
+    }
+
+    bool ignore_scalar() noexcept
+    {
+        consume_scalar();
+        return true;
+    }
+
+    // Nothing we care about is a null/number/string value.
+    bool null() { return ignore_scalar(); }
+    bool number_integer(json::number_integer_t) { return ignore_scalar(); }
+    bool number_unsigned(json::number_unsigned_t) { return ignore_scalar(); }
+    bool number_float(json::number_float_t, const json::string_t&) { return ignore_scalar(); }
+    bool string(json::string_t&) { return ignore_scalar(); }
+    bool binary(json::binary_t&) { return ignore_scalar(); }
+
+    bool boolean(bool val)
+    {
+        if (consume_scalar()) return true;
+        if (depth == 2 && field == Field::Done) current_done = val;
+        return true;
+    }
+
+    bool start_object(std::size_t)
+    {
+        if (consume_container()) return true;
+        ++depth;
+        if (depth > 3)
+        {
+            // Nothing we understand lives this deep. Shouldn't happen, but be safe.
+            --depth;
+            ++skip_level;
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t)
+    {
+        // We never care about arrays.
+        skip_next = false;
+        ++skip_level;
+        return true;
+    }
+
+    bool end_array()
+    {
+        --skip_level;
+        return true;
+    }
+
+    bool end_object()
+    {
+        if (skipping())
+        {
+            --skip_level;
+            return true;
+        }
+        if (depth == 2) finish_advancement();
+        if (depth == 3) field = Field::None;
+        --depth;
+        return true;
+    }
+
+    bool key(json::string_t& val)
+    {
+        if (skipping()) return true;
+
+        switch (depth)
+        {
+        case 1: return advancement_key(val);
+        case 2:
+            if (val == "done") field = Field::Done;
+            else if (val == "criteria") field = Field::Criteria;
+            else skip_next = true;
+            return true;
+        case 3:
+            // Criteria values are just timestamps. We only need the key.
+            mark_criterion(manifest::unprefixed(std::move(val)));
+            skip_next = true;
+            return true;
+        default: skip_next = true; return true;
+        }
+    }
+
+    bool advancement_key(const std::string& key)
+    {
+        const std::string_view adv_prefix = "minecraft:";
+        if (key.starts_with("minecraft:recipes/") or not key.starts_with(adv_prefix))
+        {
+            skip_next = true;
+            return true;
+        }
+
+        logger.debug("Found advancement: ", key);
+        // this is probably definitely totally an advancement :)
+        const auto name = std::string_view{key}.substr(adv_prefix.size());
+        current         = ret.manifest->find(name);
+        if (current == nullptr)
+        {
+            logger.error("We don't have the advancement: ", name);
+            ret.meta.valid = false;
+            // Stop parsing. Nothing after this point matters.
+            return false;
+        }
+
+        current_done = false;
+        field        = Field::None;
+        return true;
+    }
+
+    void mark_criterion(const std::string& crit_key)
+    {
+        const auto it = current->criteria.find(crit_key);
+        if (it == current->criteria.end())
+        {
+            // We will get random criteria from parsing that aren't 'real'
+            // criteria. If they're not in manifest, just ignore them.
+            return;
+        }
+        ret.criteria.set(it->second);
+    }
+
+    void finish_advancement()
+    {
+        if (current_done)
+        {
+            ret.mark_complete(*current);
+        }
+        current = nullptr;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e)
+    {
+        logger.error("Failed to parse JSON: ", e.what());
+        ret.meta.valid = false;
+        return false;
+    }
+};
+
+// One per thread (the parser runs on its own), reused between reparses.
+FileBuffer& file_buffer()
+{
+    thread_local FileBuffer buffer;
+    return buffer;
+}
+} // namespace status
+
 AdvancementStatus AdvancementStatus::from_file(std::string_view filename,
                                                const AdvancementManifest& manifest)
 {
     auto& logger = get_logger("AdvancementStatus::from_file");
-    AdvancementStatus ret{};
+    logger.debug("Loading advancements from file: ", filename);
+
+    auto& f = status::file_buffer();
+    if (not f.read(std::string{filename}))
+    {
+        logger.error("Could not open file: ", filename);
+        auto ret       = from_default(manifest);
+        ret.meta.valid = false;
+        return ret;
+    }
+    return from_contents(f.view(), manifest);
+}
+
+AdvancementStatus AdvancementStatus::from_contents(std::string_view contents,
+                                                   const AdvancementManifest& manifest)
+{
+    auto& logger = get_logger("AdvancementStatus::from_contents");
+    auto ret     = from_default(manifest);
+
+    status::StatusSaxHandler handler{ret, logger};
+    if (not json::sax_parse(contents.begin(), contents.end(), &handler))
+    {
+        // Either a parse error or an advancement we don't know about.
+        // Both have already been logged by the handler.
+        ret.meta.valid = false;
+    }
+
+    return ret;
+}
+
+AdvancementStatus AdvancementStatus::from_file_dom(std::string_view filename,
+                                                   const AdvancementManifest& manifest)
+{
+    auto& logger = get_logger("AdvancementStatus::from_file_dom");
+    auto ret     = from_default(manifest);
 
     logger.debug("Loading advancements from file: ", filename);
 
-    std::ifstream f(filename.data() /* msvc */);
-    if (!f.good())
+    auto& f = status::file_buffer();
+    if (not f.read(std::string{filename}))
     {
         logger.error("Could not open file: ", filename);
         ret.meta.valid = false;
         return ret;
     }
+    const auto contents = f.view();
 
     auto advancements = json{};
     try
     {
-        advancements = json::parse(f);
+        advancements = json::parse(contents.begin(), contents.end());
     }
     catch (std::exception& e)
     {
@@ -232,11 +532,6 @@ AdvancementStatus AdvancementStatus::from_file(std::string_view filename,
         return ret;
     }
 
-    // Copy :sob:
-    // Kind of have to do this. Because we are 'removing' things,
-    // not 'adding' them. Oh well.
-    ret.incomplete = manifest.advancements;
-
     const std::string_view adv_prefix = "minecraft:";
     for (const auto& [key, value] : advancements.items())
     {
@@ -244,10 +539,10 @@ AdvancementStatus AdvancementStatus::from_file(std::string_view filename,
 
         logger.debug("Found advancement: ", key);
         // this is probably definitely totally an advancement :)
-        auto name = key.substr(adv_prefix.size());
-        if (not ret.incomplete.contains(name))
+        const auto* adv = manifest.find(std::string_view{key}.substr(adv_prefix.size()));
+        if (adv == nullptr)
         {
-            logger.error("We don't have the advancement: ", name);
+            logger.error("We don't have the advancement: ", key);
             ret.meta.valid = false;
             return ret;
         }
@@ -256,46 +551,27 @@ AdvancementStatus AdvancementStatus::from_file(std::string_view filename,
 
         if (is_completed)
         {
-            // Basically, move from incomplete -> complete.
-            ret.complete.emplace(name, std::move(ret.incomplete[name]));
-            ret.incomplete.erase(name);
-
             // Don't need to do anything else. No criteria, etc.
+            ret.mark_complete(*adv);
             continue;
         }
 
         if (value.contains("criteria"))
         {
             // Okay, so, this is an incomplete criteria.
-            // So what we need is the criteria that do NOT exist.
-            // The easiest way to do this is to just copy over
-            // the entire "criteria for this thing" list then
-            // remove the ones we actually have while iterating.
-            // Same way that the overall system works.
-
-            // Okay, actually we DON'T have to copy anything over.
-            // Because... we already did. When we grabbed manifest
-            // advancements into our ret->advancements.
-
-            auto& adv = ret.incomplete[name];
+            // Just mark the ones that actually exist.
             for (const auto& itr : value["criteria"].items())
             {
-                // These are the ones that actually exist.
-                auto crit_key = manifest::unprefixed(itr.key());
-
-                if (not adv.criteria.contains(crit_key))
+                const auto crit = adv->criteria.find(manifest::unprefixed(itr.key()));
+                if (crit == adv->criteria.end())
                 {
                     // This is fine actually. We will get random
                     // criteria from parsing that aren't 'real'
                     // criteria. If they're not in manifest,
                     // just ignore them. Not real! Fake! !!!!!
-                    // logger.fatal_error("Criteria key ", crit_key,
-                    //                   " is not present in advancement ", name);
                     continue;
                 }
-                adv.criteria_ordered.erase(
-                    std::find(adv.criteria_ordered.begin(), adv.criteria_ordered.end(), crit_key));
-                adv.criteria.erase(crit_key);
+                ret.criteria.set(crit->second);
             }
         }
     }
@@ -306,7 +582,89 @@ AdvancementStatus AdvancementStatus::from_file(std::string_view filename,
 AdvancementStatus AdvancementStatus::from_default(const AdvancementManifest& manifest)
 {
     AdvancementStatus ret{};
-    ret.incomplete = manifest.advancements;
+    ret.manifest = &manifest;
+    ret.complete = Bitset{manifest.advancements.size()};
+    ret.criteria = Bitset{manifest.criteria.size()};
+    return ret;
+}
+
+StatusDelta StatusDelta::diff(const AdvancementStatus& older, const AdvancementStatus& newer)
+{
+    StatusDelta ret{};
+
+    if (older.manifest != newer.manifest)
+    {
+        // Ordinals mean nothing across manifests.
+        ret.reset = true;
+        return ret;
+    }
+
+    // Anything that was done must still be done. Otherwise, it's a new world (or similar).
+    if (older.complete.and_not(newer.complete).any() ||
+        older.criteria.and_not(newer.criteria).any())
+    {
+        ret.reset = true;
+        return ret;
+    }
+
+    newer.complete.and_not(older.complete)
+        .for_each_set([&](size_t i) { ret.completed.push_back(static_cast<uint32_t>(i)); });
+
+    const auto& criteria = newer.manifest->criteria;
+    newer.criteria.and_not(older.criteria)
+        .for_each_set(
+            [&](size_t i)
+            {
+                // Criteria of newly completed advancements are implied.
+                if (newer.complete.test(criteria[i].advancement)) return;
+                ret.criteria.push_back(static_cast<uint32_t>(i));
+            });
+
     return ret;
 }
-} // namespace aa
\ No newline at end of file
+
+StatusTracker::StatusTracker(const AdvancementManifest& manifest)
+    : current_(std::make_shared<const AdvancementStatus>(
+          AdvancementStatus::from_default(manifest)))
+{
+}
+
+bool StatusTracker::publish(AdvancementStatus status)
+{
+    return publish(std::make_shared<const AdvancementStatus>(std::move(status)));
+}
+
+bool StatusTracker::publish(std::shared_ptr<const AdvancementStatus> status)
+{
+    auto& logger = get_logger("StatusTracker");
+    if (not status || not status->meta.valid)
+    {
+        logger.warning("Ignoring invalid status - parse/load error.");
+        return false;
+    }
+
+    const auto delta = StatusDelta::diff(*current_, *status);
+    current_         = std::move(status);
+
+    if (delta.reset)
+    {
+        logger.debug("Status changed in a way that requires a full reset.");
+    }
+    else if (delta.empty())
+    {
+        // Nothing to tell anyone about.
+        return true;
+    }
+    else
+    {
+        logger.debug("Status delta: ", delta.completed.size(), " advancement(s) and ",
+                     delta.criteria.size(), " criteria completed.");
+    }
+
+    for (auto* handler : handlers_)
+    {
+        handler->handle_event(StatusUpdate{{}, current_.get(), &delta});
+    }
+    return true;
+}
+} // namespace aa
@@ -1,13 +1,35 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
-#include <SFML/Graphics/Texture.hpp>
 
+#include "Bitset.hpp"
+#include "Event.hpp"
+#include "IconStore.hpp"
 #include "utilities.hpp"
 
 namespace aa
 {
+/* Criterion - One criterion of an advancement (a biome, a food, a mob...).
+ * Every criterion in the manifest gets a dense ordinal, and the criteria of
+ * a single advancement are contiguous, in manifest order.
+ */
+struct Criterion
+{
+    std::string key;
+    // Name of the texture in ResourceManager::criteria_map.
+    std::string icon_name;
+    Icon icon{};
+
+    uint32_t ordinal     = 0;
+    // Ordinal of the advancement this criterion belongs to.
+    uint32_t advancement = 0;
+};
+
 struct Advancement
 {
     /* Advancement - The canonical type.
@@ -17,26 +39,38 @@ struct Advancement
      * name: adventuring_time
      * criteria: [ "plains", "wooded_hills", ... ]
      *   -> Criteria can have a custom name.
-     * icon: adventuring_time.png -> loaded into sf::Texture
+     * icon: adventuring_time.png -> an Icon, loaded when it's first drawn
      */
     std::string name;
     std::string category;
     std::string pretty_name;
     std::string short_name;
 
+    Advancement() = default;
+    // The rest is filled in by AdvancementManifest::add_advancement/add_criterion.
+    Advancement(std::string name, std::string category, std::string pretty_name,
+                std::string short_name)
+        : name(std::move(name)), category(std::move(category)),
+          pretty_name(std::move(pretty_name)), short_name(std::move(short_name))
+    {
+    }
+
     std::string full_id() const { return category + "/" + name; }
 
-    // Just do this for now. Deal with names later.
-    string_map<const sf::Texture*> criteria;
-    std::vector<std::string> criteria_ordered;
+    // Dense ordinal, assigned in manifest order at load time.
+    uint32_t ordinal = 0;
 
-    void add_criteria(std::string key, const sf::Texture* t)
-    {
-        criteria.emplace(key, t);
-        criteria_ordered.push_back(key);
-    }
+    // Our criteria are AdvancementManifest::criteria[criteria_begin, criteria_end).
+    uint32_t criteria_begin = 0;
+    uint32_t criteria_end   = 0;
+    // Criterion key -> criterion ordinal.
+    string_map<uint32_t> criteria;
+
+    uint32_t criteria_count() const noexcept { return criteria_end - criteria_begin; }
 
-    const sf::Texture* icon{};
+    // Where icon was loaded from (resolved asset path).
+    std::string icon_path;
+    Icon icon{};
 };
 
 /* AdvancementManifest
@@ -47,7 +81,44 @@ struct AdvancementManifest
 {
     static AdvancementManifest from_file(std::string_view filename);
 
-    string_map<Advancement> advancements;
+    // Indexed by ordinal.
+    std::vector<Advancement> advancements;
+    std::vector<Criterion> criteria;
+    // Full ID (e.g. adventure/adventuring_time) -> advancement ordinal.
+    string_map<uint32_t> ordinals;
+
+    // nullptr if we don't have that advancement.
+    const Advancement* find(std::string_view full_id) const
+    {
+        const auto it = ordinals.find(full_id);
+        return it == ordinals.end() ? nullptr : &advancements[it->second];
+    }
+
+    // Appends an advancement, assigning its ordinal. nullptr if it's a duplicate.
+    Advancement* add_advancement(Advancement adv);
+    // Criteria must be added to the most recently added advancement.
+    // nullptr if adv already has a criterion with that key.
+    Criterion* add_criterion(Advancement& adv, std::string key, std::string icon_name,
+                             Icon icon);
+};
+
+/* StatusTiming
+ * When a status went through each stage on its way to the screen, all on the same
+ * (steady) clock. Default constructed == unknown, e.g. for statuses that weren't
+ * parsed by StatusParser.
+ */
+struct StatusTiming
+{
+    using clock = std::chrono::steady_clock;
+
+    // The file's mtime, moved over to clock.
+    clock::time_point written{};
+    // When poll() reported the file (== when it got requested).
+    clock::time_point detected{};
+    clock::time_point parse_start{};
+    clock::time_point parse_end{};
+
+    bool known() const noexcept { return detected != clock::time_point{}; }
 };
 
 /* AdvancementStatus
@@ -56,15 +127,27 @@ struct AdvancementManifest
  *   - also all texture information
  * - player's advancements.json -> current advancements
  * - implicit: 'which advancements are incomplete'
+ *
+ * Everything is stored as bits, indexed by manifest ordinal, so a status is a
+ * few hundred bytes and questions like "how many are done" are just popcounts.
+ * Completed advancements have all of their criteria set as well.
  */
 struct AdvancementStatus
 {
+    // Streams the player's advancements file (SAX). Recipes are skipped, never built.
     static AdvancementStatus from_file(std::string_view filename, const AdvancementManifest&);
+    // Same, for a file that has already been read (e.g. by StatusParser).
+    static AdvancementStatus from_contents(std::string_view contents, const AdvancementManifest&);
+    // Old DOM-based parser. Same result as from_file, kept around for benchmarking.
+    static AdvancementStatus from_file_dom(std::string_view filename, const AdvancementManifest&);
     static AdvancementStatus from_default(const AdvancementManifest&);
 
-    // Just the basics. Advancements / Tier 1 criteria that are complete/incomplete.
-    string_map<Advancement> incomplete;
-    string_map<Advancement> complete;
+    // Always valid for statuses created through the functions above.
+    const AdvancementManifest* manifest = nullptr;
+
+    // Bit N set == advancement/criterion with ordinal N is done.
+    Bitset complete;
+    Bitset criteria;
 
     // Metainformation that we gather as we parse. All custom, because we don't want
     // to store and search through absolutely everything.
@@ -72,6 +155,77 @@ struct AdvancementStatus
     {
         bool has_egap = false;
         bool valid    = true;
+        StatusTiming timing{};
     } meta{};
+
+    // Marks an advancement (and all of its criteria) as done.
+    void mark_complete(const Advancement& adv)
+    {
+        complete.set(adv.ordinal);
+        criteria.set_range(adv.criteria_begin, adv.criteria_end);
+    }
+
+    size_t complete_count() const noexcept { return complete.count(); }
+    size_t incomplete_count() const noexcept { return complete.size() - complete.count(); }
+
+    // f(const Advancement&) for every incomplete advancement, in manifest order.
+    template <typename F>
+    void for_each_incomplete(F&& f) const
+    {
+        complete.for_each_unset_in(0, complete.size(),
+                                   [&](size_t i) { f(manifest->advancements[i]); });
+    }
+
+    // f(const Criterion&) for every criterion of adv that isn't done, in manifest order.
+    template <typename F>
+    void for_each_remaining_criterion(const Advancement& adv, F&& f) const
+    {
+        criteria.for_each_unset_in(adv.criteria_begin, adv.criteria_end,
+                                   [&](size_t i) { f(manifest->criteria[i]); });
+    }
+};
+
+/* StatusDelta
+ * The difference between two AdvancementStatus objects, in terms of progress.
+ * Progress only goes one way during a run, so we only track what got completed.
+ * Anything else (new world, file from a different instance...) is a reset.
+ */
+struct StatusDelta
+{
+    static StatusDelta diff(const AdvancementStatus& older, const AdvancementStatus& newer);
+
+    // Ordinals of advancements that went incomplete -> complete.
+    std::vector<uint32_t> completed;
+    // Ordinals of criteria completed on advancements that are still incomplete.
+    std::vector<uint32_t> criteria;
+
+    // Set if newer can't be reached from older by just completing things.
+    bool reset = false;
+
+    bool empty() const noexcept { return not reset && completed.empty() && criteria.empty(); }
+};
+
+/* StatusTracker
+ * Keeps the last valid status around and turns every new one into a StatusUpdate
+ * (with a delta) for whoever is subscribed. Invalid statuses are dropped, so a
+ * half-written file doesn't wipe out what we're displaying.
+ */
+struct StatusTracker
+{
+    StatusTracker(const AdvancementManifest& manifest);
+
+    void subscribe(weak_ptr<EventHandler> handler) { handlers_.push_back(handler); }
+
+    // Returns false if the status was invalid (and therefore ignored).
+    bool publish(AdvancementStatus status);
+    // Same, for a status somebody else keeps around too (e.g. a warm instance).
+    // No copy, we just hold on to the pointer.
+    bool publish(std::shared_ptr<const AdvancementStatus> status);
+
+    const AdvancementStatus& current() const noexcept { return *current_; }
+
+private:
+    std::shared_ptr<const AdvancementStatus> current_;
+    std::vector<weak_ptr<EventHandler>> handlers_;
 };
 } // namespace aa
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "AnimatedIcons.hpp"
+
+#include "logging.hpp"
+
+#include <algorithm>
+
+namespace aa
+{
+namespace
+{
+// Like browsers: a delay this short (0 is common) means "someone didn't set it".
+uint32_t effective_delay(uint32_t ms) { return ms < 20 ? 100 : ms; }
+} // namespace
+
+AnimatedIcons::Decoded AnimatedIcons::decode(Job job)
+{
+    Decoded ret;
+    ret.id        = job.id;
+    ret.decoder   = std::move(job.decoder);
+    ret.index     = job.index;
+    auto& decoder = ret.decoder;
+    if (not decoder.valid() && not decoder.open(job.path))
+    {
+        ret.broken = true;
+        return ret;
+    }
+
+    // Frames build on each other, so that's decoding up to it: from where the
+    // decoder is if it isn't past it yet, otherwise from the start.
+    if (decoder.frame() != GifDecoder::none && decoder.frame() > job.index) decoder.rewind();
+    while (decoder.frame() == GifDecoder::none || decoder.frame() < job.index)
+    {
+        if (not decoder.next())
+        {
+            ret.complete = true;
+            ret.broken   = decoder.frame() == GifDecoder::none;
+            return ret;
+        }
+        ret.decodes += 1;
+        if (decoder.frame() == job.known + ret.delays.size())
+        {
+            ret.delays.push_back(effective_delay(decoder.delay_ms()));
+        }
+    }
+
+    for (const auto size : job.sizes)
+    {
+        ret.frames.emplace_back(size, ResampleCache::resample(decoder.canvas().data(),
+                                                              decoder.width(),
+                                                              decoder.height(), size));
+    }
+    return ret;
+}
+
+void AnimatedIcons::show(uint32_t id, const std::string& path, uint32_t size,
+                         TextureAtlas::Region region)
+{
+    auto& animation = animations_[id];
+    if (animation.path.empty()) animation.path = path;
+
+    const auto it = std::find_if(animation.regions.begin(), animation.regions.end(),
+                                 [&](const auto& r) { return r.size == size; });
+    if (it != animation.regions.end())
+    {
+        *it = Shown{size, region};
+    }
+    else
+    {
+        animation.regions.push_back(Shown{size, region});
+    }
+}
+
+void AnimatedIcons::hide(uint32_t id, uint32_t size)
+{
+    const auto it = animations_.find(id);
+    if (it == animations_.end()) return;
+
+    auto& animation = it->second;
+    std::erase_if(animation.regions, [&](const auto& r) { return r.size == size; });
+    // Timings are kept, frames stay in the cache (for as long as they do). A
+    // decoder that's out with a job gets closed in finish().
+    if (animation.regions.empty()) animation.decoder = GifDecoder{};
+}
+
+size_t AnimatedIcons::frame_at(const Animation& animation, uint64_t t)
+{
+    if (animation.complete) t %= animation.known_ms;
+    for (size_t i = 0; i < animation.delays.size(); i++)
+    {
+        if (t < animation.delays[i]) return i;
+        t -= animation.delays[i];
+    }
+    return animation.delays.size();
+}
+
+void AnimatedIcons::upload(Shown& shown, size_t index, const ResampleCache::Pixels& pixels,
+                           TextureAtlas& atlas)
+{
+    atlas.update(shown.region, pixels.data());
+    shown.frame = index;
+    uploads_ += 1;
+}
+
+void AnimatedIcons::advance(clock::time_point now, TextureAtlas& atlas, std::vector<Job>& jobs)
+{
+    if (not epoch_) epoch_ = now;
+    const auto t = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - *epoch_).count());
+
+    for (auto& [id, animation] : animations_)
+    {
+        if (animation.regions.empty() || animation.broken || animation.decoding) continue;
+
+        const auto index = frame_at(animation, t);
+        std::vector<uint32_t> missing;
+        for (auto& shown : animation.regions)
+        {
+            if (shown.frame == index) continue;
+            if (const auto* pixels = frames_.find(key(id, shown.size, index)); pixels != nullptr)
+            {
+                upload(shown, index, *pixels, atlas);
+                continue;
+            }
+            missing.push_back(shown.size);
+        }
+        if (missing.empty()) continue;
+
+        // Whatever is missing stays on its last frame until this comes back.
+        animation.decoding = true;
+        jobs.push_back(Job{id, animation.path, std::move(animation.decoder), index,
+                           animation.delays.size(), std::move(missing)});
+    }
+}
+
+void AnimatedIcons::finish(Decoded decoded, TextureAtlas& atlas)
+{
+    auto& animation    = animations_[decoded.id];
+    animation.decoding = false;
+    decodes_ += decoded.decodes;
+
+    for (const auto delay : decoded.delays)
+    {
+        animation.delays.push_back(delay);
+        animation.known_ms += delay;
+    }
+    animation.complete = animation.complete || decoded.complete;
+    if (decoded.broken || (animation.complete && animation.delays.empty()))
+    {
+        get_logger("AnimatedIcons").error("Failed to decode animated icon: ", animation.path);
+        animation.broken = true;
+    }
+
+    // Closed if nothing showed it in the meantime, see hide().
+    animation.decoder = animation.regions.empty() ? GifDecoder{} : std::move(decoded.decoder);
+
+    // It was the current frame when it was asked for, so it goes up right away.
+    // Straight from here, in case the cache is too small to hold every size of it.
+    for (auto& [size, pixels] : decoded.frames)
+    {
+        for (auto& shown : animation.regions)
+        {
+            if (shown.size == size && shown.frame != decoded.index)
+            {
+                upload(shown, decoded.index, pixels, atlas);
+            }
+        }
+        frames_.insert(key(decoded.id, size, decoded.index), std::move(pixels));
+    }
+}
+
+void AnimatedIcons::debug() const
+{
+    auto& logger = get_logger("AnimatedIcons::debug");
+
+    const auto playing =
+        std::count_if(animations_.begin(), animations_.end(),
+                      [](const auto& kv) { return not kv.second.regions.empty(); });
+    const auto decoding =
+        std::count_if(animations_.begin(), animations_.end(),
+                      [](const auto& kv) { return kv.second.decoding; });
+    logger.debug("Animations: ", animations_.size(), " known, ", playing, " playing, ", decoding,
+                 " decoding. ", decodes_, " frame decode(s), ", uploads_, " upload(s) so far.");
+    logger.debug("Frame cache: ", frames_.size(), " frame(s), ", frames_.bytes() / 1024, "/",
+                 frames_.budget() / 1024, "KB, ", frames_.hits(), " hit(s), ", frames_.misses(),
+                 " miss(es).");
+}
+} // namespace aa
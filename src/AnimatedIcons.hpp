@@ -0,0 +1,141 @@
+#pragma once
+
+#include "ResampleCache.hpp"
+#include "TextureAtlas.hpp"
+#include "gif_decoder.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace aa
+{
+/* AnimatedIcons
+ * GIF icons that actually move. IconStore hands us every atlas region an
+ * animated icon gets (show), and advance() keeps those regions on whatever frame
+ * the clock says. Every tile with that icon draws the same region, so a new
+ * frame costs one decode and one upload per size - not per tile.
+ *
+ * Decoding and scaling happen on IconStore's decode workers, never in the frame:
+ * advance() hands out a Job for a frame it doesn't have yet (the animation's
+ * decoder goes along with it), and the regions stay on their last frame until
+ * finish() gets it back. Scaled frames go into a frame cache shared by every
+ * animation, bounded like the resample cache, so later loops mostly don't decode
+ * at all. Decoders of animations that nothing shows any more are closed.
+ *
+ * There's one clock for everything, started on the first advance(), so the same
+ * GIF is always on the same frame, wherever it is on screen.
+ */
+struct AnimatedIcons
+{
+    using clock = std::chrono::steady_clock;
+
+    // Frame index of an animation, decoded and scaled to sizes. The decoder is the
+    // animation's own, it's with the job (and nowhere else) until finish().
+    struct Job
+    {
+        uint32_t id;
+        std::string path;
+        GifDecoder decoder;
+        size_t index;
+        // How many frame delays we know already. The job reports the rest it sees.
+        size_t known;
+        std::vector<uint32_t> sizes;
+    };
+    struct Decoded
+    {
+        uint32_t id;
+        GifDecoder decoder;
+        size_t index;
+        // Of the frames the job decoded past known, in order.
+        std::vector<uint32_t> delays;
+        // Got to the end. Broken if there was nothing before it (or no file).
+        bool complete    = false;
+        bool broken      = false;
+        uint64_t decodes = 0;
+        // size -> frame index at that size. Empty if the GIF ended before it.
+        std::vector<std::pair<uint32_t, ResampleCache::Pixels>> frames;
+    };
+
+    static bool is_animated(std::string_view path) { return path.ends_with(".gif"); }
+
+    // For the decode workers. Doesn't touch anything of ours, or the GL context.
+    static Decoded decode(Job job);
+
+    // region (of the icon id, at size) should play path from now on.
+    void show(uint32_t id, const std::string& path, uint32_t size, TextureAtlas::Region region);
+    // It was evicted, stop touching it.
+    void hide(uint32_t id, uint32_t size);
+
+    // Uploads the current frame of everything shown, where that has changed and
+    // the frame is in the cache. The frames that aren't are added to jobs, at most
+    // one per animation. Needs the GL context.
+    void advance(clock::time_point now, TextureAtlas& atlas, std::vector<Job>& jobs);
+    // Takes back a finished job, and uploads its frame. Needs the GL context.
+    void finish(Decoded decoded, TextureAtlas& atlas);
+
+    void set_budget(size_t bytes) { frames_.set_budget(bytes); }
+    const ResampleCache& frames() const noexcept { return frames_; }
+
+    uint64_t decodes() const noexcept { return decodes_; }
+    uint64_t uploads() const noexcept { return uploads_; }
+
+    void debug() const;
+
+private:
+    struct Shown
+    {
+        uint32_t size;
+        TextureAtlas::Region region;
+        // The frame it holds. none right after show(), whatever is in it is stale.
+        size_t frame = GifDecoder::none;
+    };
+
+    struct Animation
+    {
+        std::string path;
+        // Closed (default constructed) while nothing shows it, and with a Job
+        // while decoding.
+        GifDecoder decoder;
+        bool decoding = false;
+        bool broken   = false;
+
+        // How long every frame seen so far is shown, and all of that together. Once
+        // complete, that's every frame, and the animation can loop.
+        std::vector<uint32_t> delays;
+        uint64_t known_ms = 0;
+        bool complete     = false;
+
+        // Usually just the one size.
+        std::vector<Shown> regions;
+    };
+
+    // (icon, size, frame). Sizes are well under 4096, and a GIF with a million
+    // frames is not an icon.
+    static uint64_t key(uint32_t id, uint32_t size, size_t frame)
+    {
+        return (static_cast<uint64_t>(id) << 32) | (uint64_t{size & 0xFFF} << 20) |
+               (frame & 0xFFFFF);
+    }
+
+    // Which frame is up t ms into the animation. Past what's been decoded so far,
+    // that's the next one: decoding it is how we find out how long it lasts.
+    static size_t frame_at(const Animation& animation, uint64_t t);
+
+    void upload(Shown& shown, size_t index, const ResampleCache::Pixels& pixels,
+                TextureAtlas& atlas);
+
+    std::unordered_map<uint32_t, Animation> animations_;
+    // key(id, size, frame) -> that frame, scaled.
+    ResampleCache frames_;
+    std::optional<clock::time_point> epoch_;
+
+    uint64_t decodes_ = 0;
+    uint64_t uploads_ = 0;
+};
+} // namespace aa
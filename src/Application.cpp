@@ -10,10 +10,13 @@
 #include "logging.hpp"
 
 #include "ConfigProvider.hpp"
-#include "FileProvider.hpp"
+#include "InstanceSet.hpp"
+#include "LatencyStats.hpp"
+#include "ManifestCache.hpp"
 #include "Overlay.hpp"
 #include "Map.hpp"
 #include "ResourceManager.hpp"
+#include "StatusParser.hpp"
 #include "WindowManager.hpp"
 
 #include "Advancements.hpp"
@@ -32,7 +35,8 @@ AppConfig Application::configure() {
     Logger::set_level(aa::conf::get_or<std::string>(conf, "log-level", "info"));
 
     return { aa::conf::get_or(conf, "loop-sleep", 1ull), aa::conf::get_or(conf, "vsync", false),
-    aa::conf::get_or<std::string>(conf, "manifest", "advancements.json") };
+    aa::conf::get_or<std::string>(conf, "manifest", "advancements.json"),
+    aa::conf::get_or<std::string>(conf, "manifest-cache", "advancements.cache") };
 }
 
 void Application::run()
@@ -42,18 +46,35 @@ void Application::run()
 
     // Todo: It would be really cool if we could do lazy/background loading
     // of assets here. Just launch off a std::thread and do window setup @ simul.
-    auto manifest = AdvancementManifest::from_file(conf.manifest);
+    auto manifest = ManifestCache::load_or_parse(conf.manifest, conf.manifest_cache);
 
     // Doesn't do anything, we're just creating bindings.
     auto& ovWindow     = aa::WindowManager::instance().get(aa::WindowID::Overlay);
     auto& mapWindow     = aa::WindowManager::instance().get(aa::WindowID::Map);
     auto& mainwindow = aa::WindowManager::instance().get(aa::WindowID::Main);
+    auto& debugWindow = aa::WindowManager::instance().get(aa::WindowID::Debug);
     ovWindow.setVerticalSyncEnabled(conf.vsync);
 
     aa::OverlayManager ov(manifest);
     aa::MapManager mapper{conf::getNS("map")};
 
-    aa::CurrentFileProvider fp;
+    // Every new status goes through here, so that consumers only get the changes.
+    aa::StatusTracker tracker(manifest);
+    tracker.subscribe(&ov);
+
+    // Files are parsed in the background. We only ever pick up finished statuses.
+    aa::StatusParser parser(manifest, aa::StatusParser::Options::from_config());
+
+    // One provider (and one warm status) per configured instance.
+    aa::InstanceSet instances;
+    std::vector<aa::InstanceSet::Update> updates;
+    // The test files below aren't any instance's, so they get their own key.
+    const auto manual_key = static_cast<uint32_t>(instances.size());
+
+    // File write -> pixels, drawn into the debug window.
+    aa::LatencyStats latency;
+    // Timings of whatever got published this frame, recorded once it's displayed.
+    std::vector<aa::StatusTiming> published;
     auto& rm = aa::ResourceManager::instance();
     auto& wm = aa::WindowManager::instance();
 
@@ -76,34 +97,38 @@ void Application::run()
                 else if (event.key.code == sf::Keyboard::B)
                 {
                     log::debug("Parsing test advancements file (1) - testing/all-everything.json");
-                    ov.reset_from_file("testing/all-everything.json", manifest);
+                    parser.request("testing/all-everything.json", manual_key);
                 }
                 else if (event.key.code == sf::Keyboard::C)
                 {
                     log::debug("Parsing test advancements file (2) - testing/no-recipes.json");
-                    ov.reset_from_file("testing/no-recipes.json", manifest);
+                    parser.request("testing/no-recipes.json", manual_key);
                 }
                 else if (event.key.code == sf::Keyboard::D)
                 {
                     log::debug("Parsing test advancements file (3) - testing/less.json");
-                    ov.reset_from_file("testing/less.json", manifest);
+                    parser.request("testing/less.json", manual_key);
                 }
                 else if (event.key.code == sf::Keyboard::E)
                 {
                     log::debug("Parsing test advancements file (4) - testing/most-complete.json");
-                    ov.reset_from_file("testing/most-complete.json", manifest);
+                    parser.request("testing/most-complete.json", manual_key);
                 }
                 else if (event.key.code == sf::Keyboard::R)
                 {
                     log::debug("Resetting to all advancements required.");
-                    ov.reset(manifest);
+                    // Otherwise, a parse that finishes later would undo the reset.
+                    parser.cancel();
+                    tracker.publish(AdvancementStatus::from_default(manifest));
                 }
                 else if (event.key.code == sf::Keyboard::P)
                 {
                     log::debug("Dumping all available debug information.");
                     ov.debug();
                     log::debug("Ticks processed: ", ticks);
-                    fp.debug();
+                    instances.debug();
+                    parser.debug();
+                    latency.debug();
                     log::debug("Finished dumping debug information.");
                 }
             }
@@ -111,10 +136,42 @@ void Application::run()
         wm.clearAll();
 
         // poll after handling events...
-        if (const auto result = fp.poll(ticks); result.has_value())
+        updates.clear();
+        instances.poll(updates);
+        for (auto& update : updates)
         {
-            log::debug("Attempting to reset from found updated file: ", result.value());
-            ov.reset_from_file(result.value(), manifest);
+            log::debug("Attempting to reset from found updated file: ", update.file);
+            parser.request(std::move(update.file), update.slot);
+        }
+
+        // Frame boundary: swap in whatever the parser finished since last frame.
+        // Instances that aren't focused just get their status kept for later.
+        for (auto& [key, status] : parser.take_all())
+        {
+            if (key == manual_key)
+            {
+                tracker.publish(std::move(status));
+            }
+            else if (const auto timing = status.meta.timing;
+                     instances.store(key, std::move(status)))
+            {
+                if (tracker.publish(instances.status(key))) published.push_back(timing);
+            }
+        }
+
+        // Switching instances: no scanning, no parsing, just a different status.
+        if (instances.take_focus_change())
+        {
+            if (const auto& status = instances.status(instances.focused()); status)
+            {
+                tracker.publish(status);
+            }
+            else
+            {
+                // Nothing parsed for it yet. Showing the previous instance's progress
+                // until then would be wrong, so show nothing done instead.
+                tracker.publish(AdvancementStatus::from_default(manifest));
+            }
         }
 
         /*
@@ -127,9 +184,19 @@ void Application::run()
         */
         ov.render(ovWindow);
         mapper.render(mapWindow, ticks);
+        latency.render(debugWindow);
 
         // Render loop end.
         wm.displayAll();
+        if (not published.empty())
+        {
+            const auto displayed = aa::StatusTiming::clock::now();
+            for (const auto& timing : published)
+            {
+                latency.record(timing, displayed);
+            }
+            published.clear();
+        }
 
         // Give control to the OS - we don't want to consume too many resources.
         std::this_thread::sleep_for(std::chrono::milliseconds(conf.sleep_ms));
@@ -11,6 +11,8 @@ struct AppConfig
     const bool vsync;
 
     const std::string manifest;
+    // Binary cache of the resolved manifest. Empty == no caching.
+    const std::string manifest_cache;
 };
 
 struct Application {
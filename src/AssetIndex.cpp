@@ -0,0 +1,171 @@
+#include "AssetIndex.hpp"
+
+#include "BinaryCache.hpp"
+#include "ResourceManager.hpp"
+#include "logging.hpp"
+#include "mapped_file.hpp"
+
+namespace aa
+{
+namespace
+{
+/* On-disk layout, see BinaryCache.
+ *
+ * [Header]
+ * [DirectoryRecord x directory_count]
+ * [AssetRecord x asset_count]
+ * [string data, strings_size bytes]
+ */
+constexpr char magic[8] = {'t', 'r', 'A', 'A', 's', 's', 'e', 't'};
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t directory_count;
+    uint32_t asset_count;
+    uint32_t unused;
+    uint64_t strings_size;
+};
+
+struct AssetRecord
+{
+    cache::StringRef name;
+    cache::StringRef path;
+};
+
+static_assert(sizeof(Header) == 32);
+static_assert(sizeof(AssetRecord) == 16);
+
+void asset_helper(const std::filesystem::directory_entry& dir_entry,
+                  std::unordered_map<std::string, std::string>& assets)
+{
+    if (!dir_entry.is_regular_file()) return;
+    const auto p = dir_entry.path();
+    const auto s = p.string();
+    if (not(s.ends_with(".png") or s.ends_with(".gif"))) return;
+    auto name = aa::ResourceManager::assetName(s);
+    if (const auto it = assets.find(name); it != assets.end())
+    {
+        // we have this asset loaded already
+        // continue unless this is HIGH RESOLUTION OOOO
+        if (s.size() < 7 || s[s.size() - 7] != '^') return;
+        auto& logger = get_logger("AssetIndex");
+        // okay that doesn't actually work properly lol.
+        // we always just want the highest resolution asset.
+        // if we make it 'here', we know that s[s.size() - 3] == '^'.
+        // We can kind of hack together how this works. Quite easily.
+        logger.debug("Got high quality image: ", s);
+        const auto& current = it->second;
+        logger.debug("Current image is: ", current);
+        if (current[current.size() - 6] > s[s.size() - 6])
+        {
+            logger.debug("Decided to keep the current image.");
+            return;
+        }
+        logger.debug("Decided to overwrite with the new image.");
+    }
+    assets.insert_or_assign(std::move(name), s);
+}
+} // namespace
+
+AssetIndex AssetIndex::scan()
+{
+    namespace fs = std::filesystem;
+
+    AssetIndex ret;
+    for (const auto* root : ResourceManager::asset_roots)
+    {
+        ret.directories.emplace_back(root, cache::mtime_of(root));
+
+        std::error_code ec;
+        if (not fs::is_directory(root, ec)) continue;
+        for (const fs::directory_entry& dir_entry : fs::recursive_directory_iterator(root, ec))
+        {
+            if (dir_entry.is_directory())
+            {
+                auto dir = dir_entry.path().string();
+                const auto mtime = cache::mtime_of(dir);
+                ret.directories.emplace_back(std::move(dir), mtime);
+                continue;
+            }
+            asset_helper(dir_entry, ret.assets);
+        }
+    }
+
+    get_logger("AssetIndex")
+        .debug("Scanned ", ret.directories.size(), " asset directories, found ",
+               ret.assets.size(), " assets.");
+    return ret;
+}
+
+std::optional<AssetIndex> AssetIndex::load(const std::string& path)
+{
+    auto& logger = get_logger("AssetIndex::load");
+
+    const MappedFile file{path};
+    if (not file.valid())
+    {
+        logger.debug("No asset index at: ", path);
+        return std::nullopt;
+    }
+
+    cache::Reader r{file.view(), "asset index", path, logger};
+    const auto header = r.header<Header>(magic, version);
+    if (not header.has_value() ||
+        not r.sized(header->directory_count * sizeof(cache::DirectoryRecord) +
+                        header->asset_count * sizeof(AssetRecord),
+                    header->strings_size))
+    {
+        return std::nullopt;
+    }
+
+    AssetIndex ret;
+    if (not r.directories(header->directory_count, ret.directories)) return std::nullopt;
+
+    ret.assets.reserve(header->asset_count);
+    for (uint32_t i = 0; i < header->asset_count; i++)
+    {
+        const auto rec = r.read<AssetRecord>();
+        ret.assets.emplace(r.str(rec.name), r.str(rec.path));
+    }
+    if (not r.ok || ret.assets.size() != header->asset_count)
+    {
+        r.inconsistent();
+        return std::nullopt;
+    }
+
+    logger.debug("Loaded ", ret.assets.size(), " assets from index: ", path);
+    return ret;
+}
+
+bool AssetIndex::store(const std::string& path) const
+{
+    cache::StringTable strings;
+    const auto dirs = cache::directory_records(directories, strings);
+
+    std::vector<AssetRecord> records;
+    records.reserve(assets.size());
+    for (const auto& [name, file] : assets)
+    {
+        records.push_back(AssetRecord{strings.add(name), strings.add(file)});
+    }
+
+    auto header            = cache::make_header<Header>(magic, version);
+    header.directory_count = static_cast<uint32_t>(dirs.size());
+    header.asset_count     = static_cast<uint32_t>(records.size());
+    header.strings_size    = strings.data.size();
+
+    return cache::write_atomically(
+        path,
+        {cache::bytes_of(header), cache::bytes_of(dirs), cache::bytes_of(records), strings.data},
+        "asset index", get_logger("AssetIndex::store"));
+}
+
+AssetIndex AssetIndex::load_or_scan(const std::string& path)
+{
+    return cache::load_or_build(
+        path, [&] { return load(path); }, [] { return scan(); },
+        [&](const AssetIndex& index) { index.store(path); });
+}
+} // namespace aa
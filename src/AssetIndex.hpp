@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace aa
+{
+/* AssetIndex
+ * Asset name -> file, for everything under ResourceManager::asset_roots (see
+ * ResourceManager::assetName for what the name of a file is). Building it means
+ * walking every root recursively, so it's persisted next to the assets, and a
+ * start only walks again if an asset directory's mtime moved.
+ *
+ * Same deal as ManifestCache: adding/removing/renaming an asset touches its
+ * directory, editing one in place doesn't (but doesn't need to, either - the
+ * index only has paths).
+ */
+struct AssetIndex
+{
+    // Bump this whenever the on-disk layout (see AssetIndex.cpp) changes.
+    static constexpr uint32_t version = 1;
+
+    // The filesystem walk.
+    static AssetIndex scan();
+
+    // nullopt if there is no index, or it is stale/corrupt.
+    static std::optional<AssetIndex> load(const std::string& path);
+
+    // Returns false if the index could not be written. Not fatal, just slower next time.
+    bool store(const std::string& path) const;
+
+    // Loads from path if we can, otherwise scans and refreshes it. An empty path
+    // disables persisting entirely.
+    static AssetIndex load_or_scan(const std::string& path);
+
+    std::unordered_map<std::string, std::string> assets;
+    // Every asset root and every directory under them, with their mtimes at scan
+    // time. Roots that don't exist are in here too (as -1), so creating one counts.
+    std::vector<std::pair<std::string, int64_t>> directories;
+};
+} // namespace aa
@@ -0,0 +1,104 @@
+#include "BinaryCache.hpp"
+
+#include <fstream>
+
+namespace aa::cache
+{
+int64_t mtime_of(const std::filesystem::path& p)
+{
+    std::error_code ec;
+    const auto t = std::filesystem::last_write_time(p, ec);
+    if (ec) return -1;
+    return static_cast<int64_t>(t.time_since_epoch().count());
+}
+
+bool Reader::sized(uint64_t records_size, uint64_t strings_size)
+{
+    if (not ok || data_.size() - pos_ != records_size + strings_size)
+    {
+        logger_.warning("Ignoring truncated ", what_, ": ", path_);
+        return false;
+    }
+    strings_ = data_.substr(data_.size() - strings_size);
+    return true;
+}
+
+std::string Reader::str(StringRef ref)
+{
+    if (static_cast<size_t>(ref.offset) + ref.size > strings_.size())
+    {
+        ok = false;
+        return {};
+    }
+    return std::string{strings_.substr(ref.offset, ref.size)};
+}
+
+bool Reader::directories(uint32_t count, Directories& out)
+{
+    // One stat per directory, no listing.
+    out.reserve(out.size() + count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const auto dir = read<DirectoryRecord>();
+        auto p         = str(dir.path);
+        if (not ok) return false;
+        if (mtime_of(p) != dir.mtime)
+        {
+            logger_.info("Asset directory ", p, " changed since the ", what_, " was written.");
+            return false;
+        }
+        out.emplace_back(std::move(p), dir.mtime);
+    }
+    return true;
+}
+
+void Reader::inconsistent() { logger_.warning("Ignoring inconsistent ", what_, ": ", path_); }
+
+StringRef StringTable::add(std::string_view s)
+{
+    const StringRef ref{static_cast<uint32_t>(data.size()), static_cast<uint32_t>(s.size())};
+    data.append(s);
+    return ref;
+}
+
+std::vector<DirectoryRecord> directory_records(const Directories& dirs, StringTable& strings)
+{
+    std::vector<DirectoryRecord> ret;
+    ret.reserve(dirs.size());
+    for (const auto& [dir, mtime] : dirs)
+    {
+        ret.push_back(DirectoryRecord{strings.add(dir), mtime});
+    }
+    return ret;
+}
+
+bool write_atomically(const std::string& path, std::initializer_list<std::string_view> parts,
+                      std::string_view what, Logger& logger)
+{
+    const auto tmp_path = path + ".tmp";
+    {
+        std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+        for (const auto part : parts)
+        {
+            f.write(part.data(), static_cast<std::streamsize>(part.size()));
+        }
+
+        if (not f.good())
+        {
+            logger.error("Failed to write ", what, ": ", tmp_path);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec)
+    {
+        logger.error("Failed to move ", what, " into place: ", ec.message());
+        return false;
+    }
+
+    logger.debug("Wrote ", what, ": ", path);
+    return true;
+}
+} // namespace aa::cache
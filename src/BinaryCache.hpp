@@ -0,0 +1,175 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace aa::cache
+{
+/* BinaryCache
+ * The plumbing shared by the on-disk caches (ManifestCache, AssetIndex). They
+ * are all laid out the same way:
+ *
+ * [Header]                          <- starts with char magic[8], uint32_t version
+ * [fixed size records...]
+ * [string data, strings_size bytes] <- referenced by StringRef
+ *
+ * Everything is fixed size and native endian - a cache never leaves the machine
+ * that wrote it. Records are read with memcpy, so nothing cares about the
+ * alignment of the mapping.
+ */
+
+struct StringRef
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+// An asset directory, and its mtime when the cache was written. If that moved,
+// something was added/removed/renamed in there and the cache is stale.
+struct DirectoryRecord
+{
+    StringRef path;
+    int64_t mtime;
+};
+
+static_assert(sizeof(DirectoryRecord) == 16);
+
+using Directories = std::vector<std::pair<std::string, int64_t>>;
+
+// -1 if p doesn't exist (or can't be statted).
+int64_t mtime_of(const std::filesystem::path& p);
+
+/* Reader
+ * Bounds-checked reads over a mapped cache. Reading past the end (or a string
+ * outside the string data) clears ok and returns zeroes/nothing, so a run of
+ * reads only needs checking once. The checks log why a cache gets ignored, as
+ * "<what>: <path>".
+ */
+struct Reader
+{
+    Reader(std::string_view data, std::string_view what, std::string_view path, Logger& logger)
+        : data_(data), what_(what), path_(path), logger_(logger)
+    {
+    }
+
+    template <typename T>
+    T read()
+    {
+        T ret{};
+        if (pos_ + sizeof(T) > data_.size())
+        {
+            ok = false;
+            return ret;
+        }
+        std::memcpy(&ret, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return ret;
+    }
+
+    // Reads the header, nullopt if it isn't ours or is from a different version.
+    template <typename Header>
+    std::optional<Header> header(const char (&magic)[8], uint32_t version)
+    {
+        const auto ret = read<Header>();
+        if (not ok || std::memcmp(ret.magic, magic, sizeof(magic)) != 0)
+        {
+            logger_.warning("Ignoring corrupt ", what_, ": ", path_);
+            return std::nullopt;
+        }
+        if (ret.version != version)
+        {
+            logger_.info("Ignoring ", what_, " from a different version (", ret.version,
+                         ", expected ", version, ").");
+            return std::nullopt;
+        }
+        return ret;
+    }
+
+    // After the header: false unless what's left is exactly records_size bytes of
+    // records, then strings_size bytes of strings.
+    bool sized(uint64_t records_size, uint64_t strings_size);
+
+    std::string str(StringRef ref);
+
+    // Reads count DirectoryRecords, false if any of them moved. Appends them to out.
+    bool directories(uint32_t count, Directories& out);
+
+    // Logs "Ignoring inconsistent <what>", for whatever the caller's own checks find.
+    void inconsistent();
+
+    bool ok = true;
+
+private:
+    std::string_view data_;
+    std::string_view strings_;
+    size_t pos_ = 0;
+    std::string what_;
+    std::string path_;
+    Logger& logger_;
+};
+
+// The string data of a cache that is being written.
+struct StringTable
+{
+    StringRef add(std::string_view s);
+
+    std::string data;
+};
+
+std::vector<DirectoryRecord> directory_records(const Directories& dirs, StringTable& strings);
+
+template <typename Header>
+Header make_header(const char (&magic)[8], uint32_t version)
+{
+    Header ret{};
+    std::memcpy(ret.magic, magic, sizeof(magic));
+    ret.version = version;
+    return ret;
+}
+
+template <typename T>
+std::string_view bytes_of(const T& value)
+{
+    return {reinterpret_cast<const char*>(&value), sizeof(T)};
+}
+
+template <typename T>
+std::string_view bytes_of(const std::vector<T>& values)
+{
+    return {reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T)};
+}
+
+// Writes parts to path + ".tmp", then renames that over path, so that a crash
+// never leaves a half-written cache. False (and logged) if that didn't work.
+bool write_atomically(const std::string& path, std::initializer_list<std::string_view> parts,
+                      std::string_view what, Logger& logger);
+
+// The load_or_* dance: an empty path disables persisting entirely. Otherwise
+// load from it if we can, or build and refresh it.
+template <typename Load, typename Build, typename Store>
+auto load_or_build(const std::string& path, Load&& load, Build&& build, Store&& store)
+{
+    if (path.empty())
+    {
+        return build();
+    }
+
+    if (auto loaded = load(); loaded.has_value())
+    {
+        return std::move(*loaded);
+    }
+
+    auto ret = build();
+    store(ret);
+    return ret;
+}
+} // namespace aa::cache
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Bitset.hpp
+// Runtime-sized bitset. std::bitset needs the size at compile time, and we only
+// know how many advancements/criteria there are once the manifest is loaded.
+// Bits past size() are always kept at zero, so count/== don't need masking.
+namespace aa
+{
+struct Bitset
+{
+    using word_t                          = uint64_t;
+    static constexpr size_t bits_per_word = 64;
+
+    Bitset() = default;
+    explicit Bitset(size_t n) : size_(n), words_((n + bits_per_word - 1) / bits_per_word) {}
+
+    size_t size() const noexcept { return size_; }
+
+    void set(size_t i)
+    {
+        assert(i < size_);
+        words_[i / bits_per_word] |= word_t{1} << (i % bits_per_word);
+    }
+
+    void reset(size_t i)
+    {
+        assert(i < size_);
+        words_[i / bits_per_word] &= ~(word_t{1} << (i % bits_per_word));
+    }
+
+    bool test(size_t i) const
+    {
+        assert(i < size_);
+        return (words_[i / bits_per_word] >> (i % bits_per_word)) & 1;
+    }
+
+    // Sets every bit in [begin, end).
+    void set_range(size_t begin, size_t end)
+    {
+        assert(begin <= end && end <= size_);
+        for (size_t i = begin; i < end; i++)
+        {
+            // Criteria ranges are a handful of bits. Not worth being clever.
+            set(i);
+        }
+    }
+
+    size_t count() const noexcept
+    {
+        size_t ret = 0;
+        for (auto w : words_) ret += std::popcount(w);
+        return ret;
+    }
+
+    // Number of set bits in [begin, end).
+    size_t count_range(size_t begin, size_t end) const
+    {
+        size_t ret = 0;
+        for_each_set_in(begin, end, [&](size_t) { ret += 1; });
+        return ret;
+    }
+
+    bool any() const noexcept
+    {
+        for (auto w : words_)
+        {
+            if (w) return true;
+        }
+        return false;
+    }
+
+    bool none() const noexcept { return not any(); }
+
+    // this & ~other. Both must be the same size.
+    Bitset and_not(const Bitset& other) const
+    {
+        assert(size_ == other.size_);
+        Bitset ret{*this};
+        for (size_t i = 0; i < words_.size(); i++) ret.words_[i] &= ~other.words_[i];
+        return ret;
+    }
+
+    Bitset& operator&=(const Bitset& other)
+    {
+        assert(size_ == other.size_);
+        for (size_t i = 0; i < words_.size(); i++) words_[i] &= other.words_[i];
+        return *this;
+    }
+
+    Bitset& operator|=(const Bitset& other)
+    {
+        assert(size_ == other.size_);
+        for (size_t i = 0; i < words_.size(); i++) words_[i] |= other.words_[i];
+        return *this;
+    }
+
+    friend bool operator==(const Bitset&, const Bitset&) = default;
+
+    // Calls f(index) for every set bit, in ascending order.
+    template <typename F>
+    void for_each_set(F&& f) const
+    {
+        for_each_set_in(0, size_, std::forward<F>(f));
+    }
+
+    // Calls f(index) for every set bit in [begin, end), in ascending order.
+    template <typename F>
+    void for_each_set_in(size_t begin, size_t end, F&& f) const
+    {
+        for_each_in(begin, end, f, [](word_t w) { return w; });
+    }
+
+    // Calls f(index) for every unset bit in [begin, end), in ascending order.
+    template <typename F>
+    void for_each_unset_in(size_t begin, size_t end, F&& f) const
+    {
+        for_each_in(begin, end, f, [](word_t w) { return ~w; });
+    }
+
+    const std::vector<word_t>& words() const noexcept { return words_; }
+
+private:
+    template <typename F, typename Transform>
+    void for_each_in(size_t begin, size_t end, F& f, Transform&& transform) const
+    {
+        assert(begin <= end && end <= size_);
+        if (begin == end) return;
+
+        const auto first = begin / bits_per_word;
+        const auto last  = (end - 1) / bits_per_word;
+        for (size_t wi = first; wi <= last; wi++)
+        {
+            word_t w = transform(words_[wi]);
+            // Mask off anything outside of [begin, end).
+            if (wi == first) w &= ~word_t{0} << (begin % bits_per_word);
+            if (wi == last && end % bits_per_word) w &= ~(~word_t{0} << (end % bits_per_word));
+            while (w)
+            {
+                f(wi * bits_per_word + std::countr_zero(w));
+                w &= w - 1;
+            }
+        }
+    }
+
+    size_t size_ = 0;
+    std::vector<word_t> words_;
+};
+} // namespace aa
@@ -4,6 +4,7 @@ namespace aa
 {
 struct AdvancementStatus;
 struct AdvancementManifest;
+struct StatusDelta;
 
 // Observer pointer... where are you... :sob:
 template<typename T>
@@ -19,7 +20,10 @@ struct ManifestUpdate : Event
 
 struct StatusUpdate : Event
 {
-    const weak_ptr<AdvancementStatus> new_status;
+    const weak_ptr<const AdvancementStatus> new_status;
+    // What changed since the previous StatusUpdate. If this is null, or the delta
+    // says it needs a reset, handlers should rebuild everything from new_status.
+    const weak_ptr<const StatusDelta> delta = nullptr;
 };
 
 struct EventHandler
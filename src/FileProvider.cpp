@@ -9,45 +9,9 @@
 
 namespace aa
 {
-std::optional<std::string> most_recent_advancement_dir(std::string_view instance_path)
+std::filesystem::path saves_dir(std::string_view instance_path)
 {
-    namespace fs = std::filesystem;
-
-    fs::path saves_path{instance_path};
-    saves_path /= ".minecraft";
-    saves_path /= "saves";
-    if (not fs::is_directory(saves_path))
-    {
-        log::debug("Not directory: ", saves_path);
-        return std::nullopt;
-    }
-
-    fs::file_time_type top_time{};
-    fs::path top_path;
-    for (auto& dir_entry : fs::directory_iterator{saves_path})
-    {
-        const auto new_time = fs::last_write_time(dir_entry.path());
-        if (new_time > top_time)
-        {
-            top_time = new_time;
-            // I dunno if this works but hey!
-            top_path = std::move(dir_entry.path());
-        }
-    }
-
-    if (top_path.empty())
-    {
-        log::debug("Did not find any saves in ", saves_path);
-        return std::nullopt;
-    }
-
-    auto adv_dir = top_path / "advancements";
-    if (fs::is_directory(adv_dir))
-    {
-        return adv_dir.string() /* for msvc */;
-    }
-    log::debug("Not directory: ", adv_dir);
-    return std::nullopt;
+    return std::filesystem::path{instance_path} / ".minecraft" / "saves";
 }
 
 auto get_modified_time(std::string_view path)
@@ -58,16 +22,13 @@ auto get_modified_time(std::string_view path)
 }
 
 
-#ifdef USE_DMON
-std::optional<std::string> most_recent_advancements(std::string_view advancements_path)
-#else
 std::optional<std::pair<std::string, std::filesystem::file_time_type>>
 most_recent_advancements(std::string_view advancements_path)
-#endif
 {
     namespace fs = std::filesystem;
 
-    fs::file_time_type top_time{};
+    // Not {}: libstdc++'s file_clock epoch is in 2174, so real mtimes are negative.
+    auto top_time = fs::file_time_type::min();
     fs::path top_path;
     for (auto& dir_entry : fs::directory_iterator{advancements_path})
     {
@@ -86,27 +47,25 @@ most_recent_advancements(std::string_view advancements_path)
         }
     }
 
-#ifdef USE_DMON
-    return top_path;
-#else
     // for msvc...
     return std::make_pair(top_path.string(), top_time);
-#endif
 }
 
-CurrentFileProvider::CurrentFileProvider()
-    : logger(/* why a pointer? */ &get_logger("CurrentFileProvider"))
-{
-    using aa::conf::get_or;
+CurrentFileProvider::CurrentFileProvider() : CurrentFileProvider(Config::from_config()) {}
 
-    // We need to know how often to poll. By default, it's once every 60 ticks.
-    auto c        = aa::conf::get();
-    poll_interval = get_or(c, "poll_interval", poll_interval);
-    if (poll_interval == 0)
-    {
-        logger->fatal_error("Invalid poll_interval of 0. Must be 1 or above.");
-    }
+CurrentFileProvider::CurrentFileProvider(const Config& config)
+    : CurrentFileProvider(config.instances, config.polling, config.native_watch,
+                          config.restat_batch)
+{
+    set_debounce(config.debounce);
+}
 
+CurrentFileProvider::CurrentFileProvider(std::vector<std::string> instance_list,
+                                         PollScheduler::Options polling, bool native_watch,
+                                         uint64_t restat_every)
+    : logger(/* why a pointer? */ &get_logger("CurrentFileProvider")),
+      instances(std::move(instance_list)), schedule(polling), restat_batch(restat_every)
+{
     /** Pipeline information:
      * Level 1: Instance detection.
      * Level 2: World detection.
@@ -117,12 +76,6 @@ CurrentFileProvider::CurrentFileProvider()
      * "automatically detecting open instances".
      */
 
-    // Instance based configuration.
-    instances = aa::conf::get_or<std::vector<std::string>>(c, "instances", {});
-    for (auto& inst : instances)
-    {
-    }
-
     if (instances.empty())
     {
         logger->debug("Choosing to autodetect instances.");
@@ -133,16 +86,176 @@ CurrentFileProvider::CurrentFileProvider()
         mode = DetectionMode::Explicit;
     }
     // watcher = dmon::Manager::instance().add_watch(conf["saves"].get<std::string>());
+
+#ifndef USE_DMON
+    if (native_watch)
+    {
+        watcher = DirectoryWatcher::create_native();
+    }
+    logger->debug(watcher ? "Using native directory notifications."
+                          : "Polling the filesystem for changes.");
+#endif
+}
+
+CurrentFileProvider::~CurrentFileProvider()
+{
+#ifdef USE_DMON
+    // saves/ stays watched (see dmon::Registry), the slot goes to whoever is next.
+    dmon::Registry::instance().unsubscribe(active_sub);
+#endif
+}
+
+CurrentFileProvider::Debounce CurrentFileProvider::Debounce::from_config()
+{
+    Debounce ret;
+    ret.quiet = std::chrono::milliseconds{aa::conf::get_or(
+        aa::conf::get(), "debounce_ms", static_cast<uint64_t>(ret.quiet.count()))};
+    ret.max_retries = aa::conf::get_or(aa::conf::get(), "debounce_retries", ret.max_retries);
+    return ret;
 }
 
-std::optional<std::string> CurrentFileProvider::poll(uint64_t ticks)
+CurrentFileProvider::Config CurrentFileProvider::Config::from_config()
 {
+    Config ret;
+    ret.instances    = aa::conf::get_or(aa::conf::get(), "instances", ret.instances);
+    ret.polling      = PollScheduler::Options::from_config();
+    ret.native_watch = aa::conf::get_or(aa::conf::get(), "native_watch", ret.native_watch);
+    ret.restat_batch = aa::conf::get_or(aa::conf::get(), "restat_batch", ret.restat_batch);
+    ret.debounce     = Debounce::from_config();
+    return ret;
+}
+
+std::optional<std::string> CurrentFileProvider::poll()
+{
+    const auto now = clock::now();
+    if (auto result = poll_for_update(now); result.has_value())
+    {
+        hold(std::move(*result), now);
+    }
+    return release(now);
+}
+
+void CurrentFileProvider::hold(std::string path, clock::time_point now)
+{
+    if (not held.path.empty())
+    {
+        // Part of the same burst (or a newer file, which makes the old one moot).
+        writes_debounced_ += 1;
+    }
+    if (path != held.path)
+    {
+        held.retries = 0;
+    }
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    held.path = std::move(path);
+    held.due  = now + debounce.quiet;
+    held.size = ec ? 0 : static_cast<uint64_t>(size);
+}
+
+bool CurrentFileProvider::retry(clock::time_point now, uint64_t size, const char* why)
+{
+    writes_debounced_ += 1;
+    if (held.retries >= debounce.max_retries)
+    {
+        logger->debug("Gave up waiting for ", held.path, " (", why, ")");
+        return false;
+    }
+    held.retries += 1;
+    held.due  = now + debounce.quiet;
+    held.size = size;
+    return true;
+}
+
+std::optional<std::string> CurrentFileProvider::release(clock::time_point now)
+{
+    if (held.path.empty() || now < held.due)
+    {
+        return std::nullopt;
+    }
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(held.path, ec);
+    if (ec)
+    {
+        // Renamed away, or deleted. Whatever replaces it will show up on its own.
+        if (not retry(now, 0, "missing")) held.path.clear();
+        return std::nullopt;
+    }
+    if (size != held.size && retry(now, size, "still growing"))
+    {
+        return std::nullopt;
+    }
+
+    // Only stats here. Reading it (and telling whether it's whole, or unchanged)
+    // is StatusParser's job, off the render thread.
+    held.retries = 0;
+    return std::exchange(held.path, std::string{});
+}
+
+std::string CurrentFileProvider::detect_instance()
+{
+    if (mode == DetectionMode::Automatic || instances.size() > 1)
+    {
+        // Get the currently active instance.
+        if (const auto fm = get_focused_minecraft(); fm.has_value())
+        {
+            if (mode == DetectionMode::Automatic)
+            {
+                return std::move(*fm);
+            }
+
+            // If we aren't in autodetection mode, that means we have 2+ instances.
+            // Only autodetect if THOSE windows are open.
+            const auto& focused = *fm;
+            if (std::any_of(instances.begin(), instances.end(),
+                            [&focused](const std::string& name) { return name == focused; }))
+            {
+                return std::move(*fm);
+            }
+
+            // We have an instance open that isn't one of the ones we watch.
+            logger->info("Ignoring focused Minecraft instance: ", *fm, ", as it is",
+                         " not one of the instances listed in \"instances\".");
+            return std::string{""};
+        }
+        // logger->debug("No minecraft instance found.");
+        // We don't currently have an instance open.
+        return std::string{""};
+    }
+    else /* A single manual instance */
+    {
+        // Guaranteed to be valid.
+        // We have no way to know if it's focused or not, so we always auto-update.
+        return instances[0];
+    }
+}
+
+std::optional<std::string> CurrentFileProvider::poll_for_update(clock::time_point now)
+{
+#ifndef USE_DMON
+    if (watcher)
+    {
+        return poll_native(now);
+    }
+#endif
+
     // Quick return at the top here before we do anything else.
-    if (ticks % poll_interval)
+    if (not schedule.due(now))
     {
         return {};
     }
+    restat_worlds();
+
+    // Finding anything (new instance, world or file) means more is probably coming.
+    auto result = scan_for_update();
+    schedule.polled(now, result.has_value());
+    return result;
+}
 
+std::optional<std::string> CurrentFileProvider::scan_for_update()
+{
     // For now, let's make this function our entire abstraction.
     // We return SOME(str) IFF we need to reset our current advancement state.
     // So: If the active window has changed; if the active world has changed;
@@ -170,43 +283,7 @@ std::optional<std::string> CurrentFileProvider::poll(uint64_t ticks)
     // I think we will poll first. However, as a quick TODO: Investigate the
     // actual runtime performance impact of the polling function, parsing function, etc.
 
-    std::string current_instance = [&]()
-    {
-        if (mode == DetectionMode::Automatic || instances.size() > 1)
-        {
-            // Get the currently active instance.
-            if (const auto fm = get_focused_minecraft(); fm.has_value())
-            {
-                if (mode == DetectionMode::Automatic)
-                {
-                    return std::move(*fm);
-                }
-
-                // If we aren't in autodetection mode, that means we have 2+ instances.
-                // Only autodetect if THOSE windows are open.
-                const auto& focused = *fm;
-                if (std::any_of(instances.begin(), instances.end(),
-                                [&focused](const std::string& name) { return name == focused; }))
-                {
-                    return std::move(*fm);
-                }
-
-                // We have an instance open that isn't one of the ones we watch.
-                logger->info("Ignoring focused Minecraft instance: ", *fm, ", as it is",
-                             " not one of the instances listed in \"instances\".");
-                return std::string{""};
-            }
-            // logger->debug("No minecraft instance found.");
-            // We don't currently have an instance open.
-            return std::string{""};
-        }
-        else /* A single manual instance */
-        {
-            // Guaranteed to be valid.
-            // We have no way to know if it's focused or not, so we always auto-update.
-            return instances[0];
-        }
-    }();
+    std::string current_instance = detect_instance();
 
     // No instances have been opened/focused ever.
     if (current_instance.empty() and active_instance.empty())
@@ -223,7 +300,7 @@ std::optional<std::string> CurrentFileProvider::poll(uint64_t ticks)
     // Let's say the user changes to an instance that isn't valid.
     // Then we want everything to stay the same.
     std::string current_advancement_dir;
-    if (auto cur = most_recent_advancement_dir(current_instance); cur.has_value())
+    if (auto cur = newest_advancement_dir(current_instance); cur.has_value())
     {
         // logger->debug("Found advancement directory: ", *cur);
         current_advancement_dir = std::move(*cur);
@@ -261,17 +338,30 @@ std::optional<std::string> CurrentFileProvider::poll(uint64_t ticks)
     std::string current_advancements_file;
 
 #ifdef USE_DMON
-    if (current_advancement_dir != active_advancement_dir || not has_active_watch())
+    auto& registry = dmon::Registry::instance();
+    if (current_advancement_dir != active_advancement_dir || not registry.alive(active_sub))
     {
         // New advancements directory. Get the most recently changed file,
         // then set a watch on the folder.
-        if (auto cur = most_recent_advancements(current_advancement_dir); cur.has_value())
+        if (auto cur = most_recent_advancements(current_advancement_dir);
+            cur.has_value() && not cur->first.empty())
         {
-            active_watch = dmon::Manager::instance().add_watch(current_advancement_dir);
+            // saves/ stays watched. Another world of the same instance is just a
+            // different prefix, no dmon calls involved.
+            const auto root = saves_dir(current_instance).string();
+            auto prefix =
+                std::filesystem::relative(current_advancement_dir, root).generic_string() + "/";
+            if (root != active_root || not registry.retarget(active_sub, prefix))
+            {
+                registry.unsubscribe(active_sub);
+                active_sub  = registry.subscribe(root, std::move(prefix));
+                active_root = root;
+            }
 
             // Okay, we have a file. This is the file we're watching now, so:
-            active_advancements    = std::move(*cur);
+            active_advancements    = std::move(cur->first);
             active_advancement_dir = std::move(current_advancement_dir);
+            last_modified          = cur->second;
 
             // This might do nothing.
             active_instance = std::move(current_instance);
@@ -280,7 +370,7 @@ std::optional<std::string> CurrentFileProvider::poll(uint64_t ticks)
             return active_advancements;
         }
         // We either don't have an active watch, or our advancement directory changed.
-        else if (not has_active_watch())
+        else if (not registry.alive(active_sub))
         {
             // We don't have an active watch. And we also could not get the current
             // advancements directory...
@@ -294,10 +384,10 @@ std::optional<std::string> CurrentFileProvider::poll(uint64_t ticks)
             // We have an active watch, but our current directory isn't the same as our
             // active one. But, our active one doesn't have a JSON file.
             // So, use our current watch to check for updates.
-            if (auto changed = active_watch.get_change(); changed.has_value())
+            if (auto changed = registry.get_change(active_sub); changed.has_value())
             {
                 // the (saves) directory being watched has updates :)
-                logger->debug("Active watcher with changes: ", active_watch.dir_,
+                logger->debug("Active watcher with changes: ", active_advancement_dir,
                               " of: ", changed.value());
                 // We DON'T want to update any of our active data. Because that's still
                 // what we have active! So just return the file that was updated.
@@ -314,10 +404,11 @@ std::optional<std::string> CurrentFileProvider::poll(uint64_t ticks)
     {
         // We haven't moved around, AND our watch exists.
         // Check if we have an update from our watch.
-        if (auto changed = active_watch.get_change(); changed.has_value())
+        if (auto changed = registry.get_change(active_sub); changed.has_value())
         {
             // the (saves) directory being watched has updates :)
-            logger->debug("watcher with changes: ", active_watch.dir_, " of: ", changed.value());
+            logger->debug("watcher with changes: ", active_advancement_dir, " of: ",
+                          changed.value());
             active_advancements = std::move(*changed);
             return active_advancements;
         }
@@ -327,8 +418,7 @@ std::optional<std::string> CurrentFileProvider::poll(uint64_t ticks)
             return std::nullopt;
         }
     }
-#endif
-
+#else
     // Goal is to get the most recently changed file.
     if (current_advancement_dir != active_advancement_dir)
     {
@@ -377,7 +467,206 @@ std::optional<std::string> CurrentFileProvider::poll(uint64_t ticks)
     }
     logger->debug("No advancements yet. :/");
     return std::nullopt;
+#endif
+}
+
+WorldIndex& CurrentFileProvider::worlds_of(const std::string& instance)
+{
+    auto it = world_indexes.find(instance);
+    if (it == world_indexes.end())
+    {
+        // First time we see this instance: this is the one expensive scan.
+        it = world_indexes.emplace(instance, WorldIndex{saves_dir(instance)}).first;
+        it->second.seed();
+    }
+    return it->second;
+}
+
+bool CurrentFileProvider::restat_worlds()
+{
+    if (active_instance.empty()) return false;
+    // Catches old worlds being played again, which nothing else notices. A few
+    // hundred stats at most, so that's never a hitch, even with 20k worlds.
+    return worlds_of(active_instance).restat(restat_batch);
+}
+
+std::optional<std::string> CurrentFileProvider::newest_advancement_dir(
+    const std::string& instance)
+{
+    namespace fs = std::filesystem;
+
+    auto& worlds = worlds_of(instance);
+    worlds.refresh();
+    const auto top_path = worlds.newest();
+    if (not top_path.has_value())
+    {
+        log::debug("Did not find any saves in ", worlds.saves_dir());
+        return std::nullopt;
+    }
+
+    auto adv_dir = *top_path / "advancements";
+    if (fs::is_directory(adv_dir))
+    {
+        return adv_dir.string() /* for msvc */;
+    }
+    log::debug("Not directory: ", adv_dir);
+    return std::nullopt;
+}
+
+std::optional<std::string> CurrentFileProvider::poll_native(clock::time_point now)
+{
+    namespace fs = std::filesystem;
+
+    // This is a single read() that comes back empty almost every time, so
+    // unlike the polling path, we can afford to do it every tick.
+    events.clear();
+    watcher->drain(events);
+
+    bool rescan = false;
+    std::optional<std::string> changed;
+    for (const auto& ev : events)
+    {
+        if (ev.overflow)
+        {
+            // We don't know what we missed. Start over.
+            if (not watched_instance.empty()) worlds_of(watched_instance).seed();
+            rescan = true;
+        }
+        else if (ev.dir == watched_saves)
+        {
+            // A world was created/deleted/renamed. Just look at that one.
+            if (not ev.name.empty()) worlds_of(watched_instance).update(ev.name);
+            rescan = true;
+        }
+        else if (ev.dir != active_advancement_dir || ev.name.empty())
+        {
+            // Something happened to the saves directory, to the newest world
+            // (e.g. it finally got an advancements directory), or we lost track.
+            rescan = true;
+        }
+        else if (ev.name.ends_with(".json"))
+        {
+            changed = (fs::path{ev.dir} / ev.name).string();
+        }
+    }
+
+    // Instances don't tell us when they get focused, so that part still polls.
+    std::string current_instance;
+    if (schedule.due(now))
+    {
+        current_instance = detect_instance();
+        if (not current_instance.empty() && current_instance != active_instance)
+        {
+            rescan = true;
+        }
+        // Before the restat, which isn't something that happened.
+        schedule.polled(now, rescan || not events.empty());
+        if (restat_worlds())
+        {
+            rescan = true;
+        }
+    }
+
+    if (rescan)
+    {
+        if (current_instance.empty()) current_instance = active_instance;
+        if (current_instance.empty()) return std::nullopt;
+
+        if (auto result = rescan_native(current_instance); result.has_value())
+        {
+            return result;
+        }
+        if (not watcher)
+        {
+            // rescan_native gave up on native watching. Poll like everyone else.
+            return poll_for_update(now);
+        }
+    }
+
+    if (changed.has_value())
+    {
+        logger->debug("Notified of changes to: ", *changed);
+        active_advancements = std::move(*changed);
+        return active_advancements;
+    }
+    return std::nullopt;
 }
 
-void CurrentFileProvider::debug() { get_active_watch().debug(); }
+std::optional<std::string> CurrentFileProvider::rescan_native(const std::string& instance)
+{
+    namespace fs = std::filesystem;
+
+    // Move our watches over, if needed. If the kernel won't give us one (e.g. we
+    // ran out of inotify watches), polling is still better than nothing.
+    auto rewatch = [&](std::string& watched, std::string wanted)
+    {
+        if (watched == wanted) return true;
+        if (not watched.empty()) watcher->unwatch(watched);
+        watched = std::move(wanted);
+        if (watched.empty() || watcher->watch(watched)) return true;
+
+        logger->warning("Could not watch ", watched, ", falling back to polling.");
+        watcher.reset();
+        watched_instance.clear();
+        watched_saves.clear();
+        watched_world.clear();
+        // Make the polling path start over from this instance.
+        active_advancement_dir.clear();
+        return false;
+    };
+
+    if (not rewatch(watched_saves, saves_dir(instance).string())) return std::nullopt;
+    watched_instance = instance;
+
+    // Only costs a stat if the watch already kept the index up to date, but
+    // instance may not have been the watched one until just now.
+    auto& worlds = worlds_of(instance);
+    worlds.refresh();
+    const auto world = worlds.newest();
+    if (not world.has_value())
+    {
+        // No worlds (yet). The saves watch will tell us when one shows up.
+        return std::nullopt;
+    }
+
+    const auto adv_dir = (*world / "advancements").string();
+    if (not fs::is_directory(adv_dir))
+    {
+        // Brand new world, the game hasn't saved any advancements yet. Watch the
+        // world itself so that we find out when it does.
+        rewatch(watched_world, world->string());
+        return std::nullopt;
+    }
+    if (not rewatch(watched_world, "")) return std::nullopt;
+
+    if (adv_dir == active_advancement_dir)
+    {
+        // Rescanned, but nothing moved.
+        return std::nullopt;
+    }
+
+    if (not rewatch(active_advancement_dir, adv_dir)) return std::nullopt;
+    active_instance = instance;
+    logger->debug("Found a new advancements directory: ", active_advancement_dir);
+
+    // Same as the polling path: report whatever is newest in there right away.
+    if (auto cur = most_recent_advancements(active_advancement_dir);
+        cur.has_value() && not cur->first.empty())
+    {
+        active_advancements = std::move(cur->first);
+        last_modified       = cur->second;
+        return active_advancements;
+    }
+    return std::nullopt;
+}
+
+void CurrentFileProvider::debug()
+{
+    logger->debug("Events absorbed by the debounce: ", writes_debounced_);
+    logger->debug("Polls: ", schedule.polls(), " (", schedule.active_polls(),
+                  " found something), currently every ", schedule.interval().count(), "ms");
+#ifdef USE_DMON
+    dmon::Registry::instance().debug();
+#endif
+}
 } // namespace aa
\ No newline at end of file
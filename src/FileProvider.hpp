@@ -1,11 +1,19 @@
 #pragma once
 
+#include "dir_watcher.hpp"
 #include "dmon.hpp"
+#include "PollScheduler.hpp"
+#include "WorldIndex.hpp"
+#include "utilities.hpp"
 
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <memory>
 
 namespace aa
 {
@@ -18,43 +26,115 @@ enum class DetectionMode {
 
 struct CurrentFileProvider
 {
+    // Saving isn't atomic from where we stand: the game writes a temporary file
+    // and renames it, and a save is usually several events in a row. A file is
+    // only reported once it has been quiet (no new events, same size) for a little
+    // while. If it isn't, we wait again, at most max_retries times, instead of
+    // waiting for the next poll.
+    struct Debounce
+    {
+        std::chrono::milliseconds quiet{100};
+        uint32_t max_retries = 5;
+
+        // From "debounce_ms" and "debounce_retries".
+        static Debounce from_config();
+    };
+
+    struct Config
+    {
+        // Empty means autodetection.
+        std::vector<std::string> instances;
+        PollScheduler::Options polling;
+        bool native_watch     = true;
+        uint64_t restat_batch = 256;
+        Debounce debounce;
+
+        // From "instances", "native_watch", "restat_batch", and the polling and
+        // debounce settings. Shared with InstanceSet.
+        static Config from_config();
+    };
+
     // FileProvider is an abstraction that allows us to swap out/improve how
     // and when we decide to poll for AA json files.
     // For now, we are only thinking about 1 player worlds.
     CurrentFileProvider();
+    explicit CurrentFileProvider(const Config& config);
 
-    std::optional<std::string> poll(uint64_t ticks = 0);
+    // Same thing, without going through the config. Each instance is a directory
+    // containing .minecraft/saves/. An empty list means autodetection. If
+    // native_watch is set (and the platform supports it), directory changes are
+    // picked up through the OS instead of by polling.
+    CurrentFileProvider(std::vector<std::string> instances, PollScheduler::Options polling,
+                        bool native_watch, uint64_t restat_batch = 256);
+    // Hands our dmon subscription back, if we have one.
+    ~CurrentFileProvider();
+
+    CurrentFileProvider(const CurrentFileProvider&)            = delete;
+    CurrentFileProvider& operator=(const CurrentFileProvider&) = delete;
+
+    // Returns the advancements file to reparse, if there is one. Files that are
+    // still being written are held back (see Debounce). Call every tick, even
+    // when nothing is due, so that held back files come out on time. Unchanged
+    // rewrites are StatusParser's problem.
+    std::optional<std::string> poll();
+
+    // Poll right away (and quickly for a while), e.g. because we just got focus.
+    void wake() { schedule.wake(PollScheduler::clock::now()); }
+    const PollScheduler& scheduler() const noexcept { return schedule; }
+
+    void set_debounce(Debounce d) noexcept { debounce = d; }
 
     void debug();
 
-    bool has_active_watch() const noexcept
-    {
-        //return not active_watch.empty();
-        return active_watch.is_active();
-    }
-
-    // Note: It's very easy to modify these watchers...
-    // Please be careful with this API.
-    // ONLY call if there is an active watch.
-    dmon::Watch& get_active_watch()
-    {
-        /*
-        if (not has_active_watch())
-        {
-            logger->fatal_error("Active watch does not exist.");
-        }
-        return watches.at(active_watch);
-        */
-        return active_watch;
-    }
+    // False if we're polling the filesystem (no native backend, or it failed).
+    bool is_native() const noexcept { return watcher != nullptr; }
+
+    // How many events got folded into a later one, or waited out, by the debounce.
+    uint64_t writes_debounced() const noexcept { return writes_debounced_; }
+
+    // Only ever true with USE_DMON. Note that the watch is on the whole saves/
+    // directory, see dmon::Registry.
+    bool has_active_watch() const noexcept { return active_sub.valid(); }
 
 private:
+    using clock = std::chrono::steady_clock;
+
+    // The actual instance/world/file detection. poll() debounces this.
+    std::optional<std::string> poll_for_update(clock::time_point now);
+    // The polling part of that, once the scheduler says it's time.
+    std::optional<std::string> scan_for_update();
+
+    // Same, driven by watcher events instead of walking directories.
+    std::optional<std::string> poll_native(clock::time_point now);
+    // Re-finds the newest world of instance and moves our watches to it.
+    std::optional<std::string> rescan_native(const std::string& instance);
+
+    // Level 1: which instance should we be looking at? Empty if none.
+    std::string detect_instance();
+
+    // Level 2: the advancements directory of the newest world of instance.
+    std::optional<std::string> newest_advancement_dir(const std::string& instance);
+    // Created (and seeded) the first time an instance is looked at.
+    WorldIndex& worlds_of(const std::string& instance);
+    // Call once per poll. Re-stats a slice of the active instance's worlds, true
+    // if that moved any of them.
+    bool restat_worlds();
+
+    // Holds path back until it's quiet. Replaces whatever was held back before.
+    void hold(std::string path, clock::time_point now);
+    // The held back file, once it is due and settled.
+    std::optional<std::string> release(clock::time_point now);
+    // Something was off with the held file. Wait again, or give up. True if we wait.
+    bool retry(clock::time_point now, uint64_t size, const char* why);
+
     Logger* logger;
 
     std::vector<std::string> instances;
     DetectionMode mode = DetectionMode::Automatic;
 
-    dmon::Watch active_watch;
+    // Our subscription to the active advancements directory, and the saves/ it's in.
+    dmon::Registry::Handle active_sub;
+    std::string active_root;
 
     // e.g. instances/XYZ
     std::string active_instance;
@@ -64,9 +144,34 @@ private:
     std::string active_advancements;
     std::filesystem::file_time_type last_modified;
 
-    // Should these defaults all be in like, DEFAULTS.hpp
-    // so they can be properly documented/referred to?
-    // e.g. /* poll_interval */ DEFAULT_POLL_INTERVAL
-    uint64_t poll_interval = 60;
+    Debounce debounce;
+    struct
+    {
+        // Empty if nothing is held back.
+        std::string path;
+        clock::time_point due;
+        // Size when it was last seen. Has to match when it is due.
+        uint64_t size    = 0;
+        uint32_t retries = 0;
+    } held;
+    uint64_t writes_debounced_ = 0;
+
+    // When to look at the filesystem next. Backs off while nothing happens.
+    PollScheduler schedule;
+
+    // Native watching. Null if we are polling instead.
+    std::unique_ptr<DirectoryWatcher> watcher;
+    std::vector<DirectoryWatcher::Event> events;
+    // e.g. XYZ, and XYZ/.minecraft/saves
+    std::string watched_instance;
+    std::string watched_saves;
+    // Newest world, only while it has no advancements directory yet.
+    std::string watched_world;
+
+    // Worlds of every instance we've looked at, by instance path.
+    string_map<WorldIndex> world_indexes;
+    // Worlds re-stat'ed per poll, in case an old world got played again. See
+    // WorldIndex::restat.
+    uint64_t restat_batch = 256;
 };
 }  // namespace aa
@@ -0,0 +1,266 @@
+#include "IconStore.hpp"
+
+#include "logging.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <tuple>
+
+namespace aa
+{
+namespace
+{
+// Decode + scale. Doesn't touch the GL context, so it's fine off the main thread.
+std::optional<ResampleCache::Pixels> load_scaled(const std::string& path, uint32_t size)
+{
+    sf::Image image;
+    if (not image.loadFromFile(path)) return std::nullopt;
+    const auto [w, h] = image.getSize();
+    if (image.getPixelsPtr() == nullptr) return std::nullopt;
+    return ResampleCache::resample(image.getPixelsPtr(), w, h, size);
+}
+} // namespace
+
+IconStore::~IconStore()
+{
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+Icon IconStore::intern(std::string path)
+{
+    if (const auto it = ids_.find(path); it != ids_.end())
+    {
+        return Icon{it->second};
+    }
+    const auto id = static_cast<uint32_t>(paths_.size());
+    ids_.emplace(path, id);
+    paths_.push_back(std::move(path));
+    return Icon{id};
+}
+
+TextureAtlas::Region IconStore::upload(Icon icon, uint32_t size,
+                                      const ResampleCache::Pixels* pixels)
+{
+    if (pixels == nullptr)
+    {
+        get_logger("IconStore").error("Failed to load icon: ", path(icon));
+        failed_.insert(icon.id);
+        return {};
+    }
+
+    loads_ += 1;
+    const auto region = atlas_.insert(pixels->data(), size);
+    resident_.emplace(key(icon, size), region);
+    // That's the first frame. From here on it plays.
+    if (AnimatedIcons::is_animated(path(icon)))
+    {
+        animations_.show(icon.id, path(icon), size, region);
+    }
+    return region;
+}
+
+TextureAtlas::Region IconStore::resolve(Icon icon, uint32_t size)
+{
+    if (not icon.valid() || failed_.contains(icon.id)) return {};
+    if (const auto it = resident_.find(key(icon, size)); it != resident_.end())
+    {
+        return it->second;
+    }
+
+    // Evicted, but still scaled in memory?
+    if (const auto* pixels = resampled_.find(key(icon, size)); pixels != nullptr)
+    {
+        return upload(icon, size, pixels);
+    }
+    request(icon, size);
+    return {};
+}
+
+void IconStore::prefetch(std::span<const Icon> icons, uint32_t size)
+{
+    for (const auto icon : icons)
+    {
+        // Usually resident already, or (just the one that scrolled into view) queued.
+        std::ignore = resolve(icon, size);
+    }
+}
+
+void IconStore::request(Icon icon, uint32_t size)
+{
+    // The same icon can show up more than once (shared criteria icons, or a
+    // turntable shorter than the window), and gets prefetched every frame.
+    if (not pending_.insert(key(icon, size)).second) return;
+
+    start_workers();
+    {
+        std::lock_guard lock{mutex_};
+        queue_.push_back({key(icon, size), path(icon), size});
+    }
+    wake_.notify_one();
+}
+
+void IconStore::start_workers()
+{
+    if (not workers_.empty()) return;
+
+    // Decoding is mostly waiting on the disk and the PNG decoder. A few are
+    // plenty, even for a cold start with every tile missing.
+    const auto count = std::clamp<unsigned>(std::thread::hardware_concurrency(), 1, 4);
+    for (unsigned i = 0; i < count; i++)
+    {
+        workers_.emplace_back([this] { run(); });
+    }
+}
+
+void IconStore::run()
+{
+    std::unique_lock lock{mutex_};
+    while (true)
+    {
+        wake_.wait(lock,
+                   [this] { return stop_ || not queue_.empty() || not frame_queue_.empty(); });
+        if (stop_) return;
+        busy_ += 1;
+
+        // Don't hold the lock while we do I/O. A gap in the turntable is worse than
+        // an animation that's a frame late, so icons go first.
+        if (not queue_.empty())
+        {
+            auto job = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            auto pixels = load_scaled(job.path, job.size);
+            lock.lock();
+            finished_.push_back({job.key, std::move(pixels)});
+        }
+        else
+        {
+            auto job = std::move(frame_queue_.front());
+            frame_queue_.pop_front();
+            lock.unlock();
+            auto decoded = AnimatedIcons::decode(std::move(job));
+            lock.lock();
+            decoded_.push_back(std::move(decoded));
+        }
+
+        busy_ -= 1;
+        if (queue_.empty() && frame_queue_.empty() && busy_ == 0) idle_.notify_all();
+    }
+}
+
+void IconStore::upload_finished()
+{
+    {
+        std::lock_guard lock{mutex_};
+        if (finished_.empty()) return;
+        std::swap(finished_, uploading_);
+    }
+
+    for (auto& [k, pixels] : uploading_)
+    {
+        const auto icon = Icon{static_cast<uint32_t>(k >> 32)};
+        const auto size = static_cast<uint32_t>(k & 0xFFFFFFFF);
+        if (not pending_.erase(k) || resident_.contains(k))
+        {
+            // retain() dropped it while it was loading (or it got back in from the
+            // cache since). Keep the pixels, in case.
+            if (pixels.has_value()) resampled_.insert(k, std::move(*pixels));
+            continue;
+        }
+        if (not pixels.has_value())
+        {
+            upload(icon, size, nullptr);
+            continue;
+        }
+        upload(icon, size, &resampled_.insert(k, std::move(*pixels)));
+    }
+    uploading_.clear();
+}
+
+void IconStore::wait()
+{
+    {
+        std::unique_lock lock{mutex_};
+        idle_.wait(lock,
+                   [this] { return queue_.empty() && frame_queue_.empty() && busy_ == 0; });
+    }
+    upload_finished();
+}
+
+void IconStore::animate(AnimatedIcons::clock::time_point now)
+{
+    {
+        std::lock_guard lock{mutex_};
+        std::swap(decoded_, animating_);
+    }
+    for (auto& decoded : animating_)
+    {
+        animations_.finish(std::move(decoded), atlas_);
+    }
+    animating_.clear();
+
+    animations_.advance(now, atlas_, frame_jobs_);
+    if (frame_jobs_.empty()) return;
+
+    start_workers();
+    {
+        std::lock_guard lock{mutex_};
+        for (auto& job : frame_jobs_)
+        {
+            frame_queue_.push_back(std::move(job));
+        }
+    }
+    frame_jobs_.clear();
+    wake_.notify_all();
+}
+
+void IconStore::retain(std::span<const Icon> keep, uint32_t size)
+{
+    std::unordered_set<uint64_t> kept;
+    kept.reserve(keep.size());
+    for (const auto icon : keep)
+    {
+        kept.insert(key(icon, size));
+    }
+
+    // Still loading. upload_finished() won't make these resident.
+    std::erase_if(pending_, [&](uint64_t k)
+                  { return (k & 0xFFFFFFFF) == size && not kept.contains(k); });
+
+    std::erase_if(resident_,
+                  [&](const auto& kv)
+                  {
+                      const auto& [k, region] = kv;
+                      if ((k & 0xFFFFFFFF) != size || kept.contains(k)) return false;
+                      const auto id = static_cast<uint32_t>(k >> 32);
+                      if (AnimatedIcons::is_animated(paths_[id])) animations_.hide(id, size);
+                      atlas_.release(region);
+                      evictions_ += 1;
+                      return true;
+                  });
+}
+
+void IconStore::debug() const
+{
+    auto& logger = get_logger("IconStore::debug");
+
+    logger.debug("Icons: ", paths_.size(), " known, ", resident_.size(), " resident, ",
+                 pending_.size(), " loading, ", failed_.size(), " failed. ", loads_, " load(s), ", evictions_,
+                 " eviction(s) so far.");
+    logger.debug("Resample cache: ", resampled_.size(), " icon(s), ", resampled_.bytes() / 1024,
+                 "/", resampled_.budget() / 1024, "KB, ", resampled_.hits(), " hit(s), ",
+                 resampled_.misses(), " miss(es).");
+    animations_.debug();
+    atlas_.debug();
+}
+} // namespace aa
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "AnimatedIcons.hpp"
+#include "ResampleCache.hpp"
+#include "TextureAtlas.hpp"
+#include "utilities.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace aa
+{
+/* Icon - a handle to an image file that may or may not be loaded right now.
+ * Cheap to copy around, resolve it with IconStore::resolve when drawing.
+ */
+struct Icon
+{
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+    uint32_t id                    = none;
+
+    bool valid() const noexcept { return id != none; }
+    bool operator==(const Icon&) const = default;
+};
+
+/* IconStore
+ * Owns every Icon, and decides which of them are actually resident: decoded,
+ * scaled and copied into the atlas, at a given size. Nothing is loaded up front -
+ * an icon becomes resident the first time it's resolved (or prefetched), and
+ * stops being resident when it's evicted. So the GPU/RAM footprint follows what
+ * is (about to be) on screen, rather than every asset we know about.
+ *
+ * Loading from disk never happens on the render thread: missing icons are queued
+ * for a few persistent decode workers, and the frame goes on without them (the
+ * turntable leaves a gap). upload_finished() brings in whatever they got done, at
+ * the start of a later frame.
+ *
+ * Decoded images are thrown away as soon as they are scaled. The scaled pixels
+ * stay around in a (bounded) ResampleCache, so bringing an icon back after an
+ * eviction is just an upload, and that one does happen right away.
+ *
+ * Animated (.gif) icons are resident like any other, but the region then keeps
+ * getting the current frame, see AnimatedIcons. Those frames are decoded and
+ * scaled by the same workers, after any icon that's still missing.
+ */
+struct IconStore
+{
+    IconStore() = default;
+    // Joins the decode workers. Whatever they were still loading is dropped.
+    ~IconStore();
+
+    IconStore(const IconStore&)            = delete;
+    IconStore& operator=(const IconStore&) = delete;
+
+    // No IO. The same path always gets the same Icon.
+    Icon intern(std::string path);
+    const std::string& path(Icon icon) const { return paths_[icon.id]; }
+
+    // Where icon is at size x size. If it isn't resident, it gets queued for
+    // loading, and the region is empty (nullptr texture) until upload_finished()
+    // picks it up. Also empty if it can't be loaded. Needs the GL context.
+    TextureAtlas::Region resolve(Icon icon, uint32_t size);
+
+    // Queues every icon that isn't resident at size, in order. Never waits.
+    void prefetch(std::span<const Icon> icons, uint32_t size);
+
+    // Uploads whatever the decode workers finished since the last call. Once per
+    // frame, before drawing. Needs the GL context.
+    void upload_finished();
+    // Waits for everything queued so far, then uploads it. Not for the render
+    // loop: that's what the workers are there to avoid.
+    void wait();
+
+    // Evicts everything resident at size that isn't in keep. Queued icons that
+    // aren't in keep won't become resident either.
+    void retain(std::span<const Icon> keep, uint32_t size);
+
+    // Moves every resident animated icon on to its frame for now, as far as the
+    // decode workers have got. Once per frame, before drawing. Needs the GL context.
+    void animate(AnimatedIcons::clock::time_point now);
+
+    // For the scaled pixels kept around after upload.
+    void set_cache_budget(size_t bytes) { resampled_.set_budget(bytes); }
+    const ResampleCache& cache() const noexcept { return resampled_; }
+    // For the decoded frames of animated icons.
+    void set_frame_budget(size_t bytes) { animations_.set_budget(bytes); }
+    const AnimatedIcons& animations() const noexcept { return animations_; }
+
+    size_t resident() const noexcept { return resident_.size(); }
+    // Queued or being decoded.
+    size_t pending() const noexcept { return pending_.size(); }
+    uint64_t loads() const noexcept { return loads_; }
+    uint64_t evictions() const noexcept { return evictions_; }
+
+    void debug() const;
+
+private:
+    static uint64_t key(Icon icon, uint32_t size)
+    {
+        return (static_cast<uint64_t>(icon.id) << 32) | size;
+    }
+
+    // Uploads pixels (or logs that there weren't any) and makes the icon resident.
+    TextureAtlas::Region upload(Icon icon, uint32_t size, const ResampleCache::Pixels* pixels);
+
+    // Hands icon to the decode workers, unless it's already with them.
+    void request(Icon icon, uint32_t size);
+    void start_workers();
+    void run();
+
+    struct Job
+    {
+        uint64_t key;
+        // A copy: paths_ can grow while the worker has it.
+        std::string path;
+        uint32_t size;
+    };
+    struct Finished
+    {
+        uint64_t key;
+        // nullopt if it couldn't be loaded.
+        std::optional<ResampleCache::Pixels> pixels;
+    };
+
+    std::vector<std::string> paths_;
+    string_map<uint32_t> ids_;
+
+    ResampleCache resampled_;
+    AnimatedIcons animations_;
+    TextureAtlas atlas_;
+    // key(icon, size) -> where it is.
+    std::unordered_map<uint64_t, TextureAtlas::Region> resident_;
+    // Icons whose file failed to load. Not retried, that would be every frame.
+    std::unordered_set<uint32_t> failed_;
+
+    // key(icon, size) of everything requested but not uploaded yet. Main thread only.
+    std::unordered_set<uint64_t> pending_;
+
+    // Everything below is guarded by mutex_.
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    // Signalled when the queue runs dry and no worker is busy.
+    std::condition_variable idle_;
+    std::deque<Job> queue_;
+    std::vector<Finished> finished_;
+    // Animation frames. Only picked up while queue_ is empty.
+    std::deque<AnimatedIcons::Job> frame_queue_;
+    std::vector<AnimatedIcons::Decoded> decoded_;
+    size_t busy_ = 0;
+    bool stop_   = false;
+
+    // Swapped with finished_/decoded_, so that uploading doesn't hold the lock.
+    std::vector<Finished> uploading_;
+    std::vector<AnimatedIcons::Decoded> animating_;
+    // What animate() has for the workers. Main thread only, kept for its capacity.
+    std::vector<AnimatedIcons::Job> frame_jobs_;
+    // Started with the first request.
+    std::vector<std::thread> workers_;
+
+    uint64_t loads_     = 0;
+    uint64_t evictions_ = 0;
+};
+} // namespace aa
@@ -0,0 +1,99 @@
+#include "InstanceSet.hpp"
+
+#include "app_finder.hpp"
+#include "logging.hpp"
+
+namespace aa
+{
+InstanceSet::InstanceSet() : InstanceSet(CurrentFileProvider::Config::from_config()) {}
+
+InstanceSet::InstanceSet(const CurrentFileProvider::Config& config)
+    : logger(&get_logger("InstanceSet")), focus_schedule(config.polling)
+{
+    const auto& instances = config.instances;
+    if (instances.size() <= 1)
+    {
+        // Autodetection (or a single instance): nothing to keep warm, the one
+        // provider follows whatever is focused, same as always.
+        instances_.push_back({instances.empty() ? std::string{} : instances[0],
+                              std::make_unique<CurrentFileProvider>(config), nullptr});
+        return;
+    }
+
+    logger->debug("Keeping ", instances.size(), " instances warm.");
+    for (const auto& path : instances)
+    {
+        // A provider with exactly one instance never checks focus, it just follows
+        // that instance. Focus is our job.
+        auto single      = config;
+        single.instances = {path};
+        instances_.push_back({path, std::make_unique<CurrentFileProvider>(single), nullptr});
+    }
+}
+
+bool InstanceSet::update_focus()
+{
+    const auto fm = get_focused_minecraft();
+    if (not fm.has_value())
+    {
+        // Nothing focused (e.g. OBS is). Keep showing whatever we were showing.
+        return false;
+    }
+    for (uint32_t slot = 0; slot < instances_.size(); slot++)
+    {
+        if (instances_[slot].path != *fm) continue;
+        if (slot == focused_) return false;
+
+        logger->debug("Focus moved to ", *fm);
+        focused_       = slot;
+        focus_changed_ = true;
+        // Whatever it was doing while unfocused, it's about to be played.
+        instances_[slot].provider->wake();
+        return true;
+    }
+    logger->info("Ignoring focused Minecraft instance: ", *fm, ", as it is",
+                 " not one of the instances listed in \"instances\".");
+    return false;
+}
+
+void InstanceSet::poll(std::vector<Update>& out)
+{
+    if (const auto now = PollScheduler::clock::now();
+        instances_.size() > 1 && focus_schedule.due(now))
+    {
+        focus_schedule.polled(now, update_focus());
+    }
+
+    for (uint32_t slot = 0; slot < instances_.size(); slot++)
+    {
+        if (auto file = instances_[slot].provider->poll(); file.has_value())
+        {
+            out.push_back({slot, std::move(*file)});
+        }
+    }
+}
+
+bool InstanceSet::store(uint32_t slot, AdvancementStatus status)
+{
+    if (not status.meta.valid)
+    {
+        // Probably caught the game mid-write. The last good one is still good.
+        logger->warning("Not keeping invalid status for instance ", slot, ".");
+        return false;
+    }
+    instances_[slot].status = std::make_shared<const AdvancementStatus>(std::move(status));
+    return slot == focused_;
+}
+
+void InstanceSet::debug()
+{
+    for (uint32_t slot = 0; slot < instances_.size(); slot++)
+    {
+        const auto& inst = instances_[slot];
+        logger->debug("Instance ", slot, slot == focused_ ? " (focused)" : "", ": ",
+                      inst.path.empty() ? "<autodetected>" : inst.path,
+                      ", parsed: ", inst.status ? "Yes" : "No");
+        inst.provider->debug();
+    }
+}
+} // namespace aa
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Advancements.hpp"
+#include "FileProvider.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aa
+{
+struct Logger;
+
+/* InstanceSet
+ * Wall resetters cycle through 4-12 instances, over and over. Following only the
+ * focused one means every focus switch moves the watch, looks for the newest
+ * world again and reparses, for an instance we were looking at seconds ago.
+ *
+ * Instead, every configured instance gets its own CurrentFileProvider (so, its
+ * own watch and world index) and its own StatusParser key (so, its own
+ * fingerprints), polled whether it is focused or not, and keeps its own last
+ * parsed status. A focus change just hands the tracker a different, already
+ * parsed, status.
+ *
+ * With zero or one instances configured, this is a single provider, and behaves
+ * exactly like one (autodetection included).
+ */
+struct InstanceSet
+{
+    // See CurrentFileProvider::Config::from_config.
+    InstanceSet();
+    explicit InstanceSet(const CurrentFileProvider::Config& config);
+
+    struct Update
+    {
+        // Which instance this file belongs to. Stable, and < size().
+        uint32_t slot;
+        std::string file;
+    };
+    // Appends every file that needs a (re)parse, from every instance, to out.
+    void poll(std::vector<Update>& out);
+
+    size_t size() const noexcept { return instances_.size(); }
+
+    uint32_t focused() const noexcept { return focused_; }
+    // True (once) if focused() changed since the last call.
+    bool take_focus_change() noexcept { return std::exchange(focus_changed_, false); }
+
+    // Keeps status as slot's latest, unless it is invalid. Returns true if it was
+    // kept and slot is the focused instance, i.e. it should be published.
+    bool store(uint32_t slot, AdvancementStatus status);
+
+    // Slot's latest status. Null until its first file got parsed.
+    const std::shared_ptr<const AdvancementStatus>& status(uint32_t slot) const
+    {
+        return instances_[slot].status;
+    }
+
+    void debug();
+
+private:
+    // True if the focus moved.
+    bool update_focus();
+
+    struct Instance
+    {
+        // Empty if we're autodetecting.
+        std::string path;
+        std::unique_ptr<CurrentFileProvider> provider;
+        std::shared_ptr<const AdvancementStatus> status;
+    };
+
+    Logger* logger;
+
+    std::vector<Instance> instances_;
+    // Focus checks back off too: nobody switches instances while paused.
+    PollScheduler focus_schedule;
+
+    uint32_t focused_   = 0;
+    bool focus_changed_ = false;
+};
+} // namespace aa
@@ -0,0 +1,143 @@
+#include "LatencyStats.hpp"
+
+#include "ResourceManager.hpp"
+#include "logging.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace aa
+{
+namespace
+{
+size_t bucket_of(double ms)
+{
+    if (ms < 1) return 0;
+    return std::min(LatencyStats::buckets - 1, static_cast<size_t>(std::log2(ms)) + 1);
+}
+
+double ms_between(StatusTiming::clock::time_point from, StatusTiming::clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+std::string summary(std::string_view name, size_t n, float p50, float p99, float max)
+{
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "%.*s: p50 %.1fms, p99 %.1fms, max %.1fms (n=%zu)",
+                  static_cast<int>(name.size()), name.data(), p50, p99, max, n);
+    return buf;
+}
+} // namespace
+
+std::string_view LatencyStats::stage_name(Stage stage)
+{
+    switch (stage)
+    {
+    case WriteToDetect: return "write -> detect";
+    case DetectToParse: return "detect -> parse";
+    case Parse: return "parse";
+    case ParseToDisplay: return "parse -> display";
+    case Total: return "write -> display";
+    case StageCount: break;
+    }
+    return "?";
+}
+
+void LatencyStats::Series::add(double ms)
+{
+    samples[next] = static_cast<float>(ms);
+    next          = (next + 1) % window;
+    size          = std::min(size + 1, window);
+
+    histogram.fill(0);
+    for (size_t i = 0; i < size; i++)
+    {
+        histogram[bucket_of(samples[i])] += 1;
+    }
+
+    auto sorted = samples;
+    std::sort(sorted.begin(), sorted.begin() + static_cast<ptrdiff_t>(size));
+    const auto at = [&](double p) { return sorted[static_cast<size_t>(p * (size - 1))]; };
+    p50 = at(0.5);
+    p99 = at(0.99);
+    max = sorted[size - 1];
+}
+
+void LatencyStats::record(const StatusTiming& timing, StatusTiming::clock::time_point displayed)
+{
+    if (not timing.known()) return;
+
+    recorded_ += 1;
+    // The mtime can be unknown (file gone by the time we parsed it), the rest can't.
+    if (timing.written != StatusTiming::clock::time_point{})
+    {
+        series_[WriteToDetect].add(ms_between(timing.written, timing.detected));
+        series_[Total].add(ms_between(timing.written, displayed));
+    }
+    series_[DetectToParse].add(ms_between(timing.detected, timing.parse_start));
+    series_[Parse].add(ms_between(timing.parse_start, timing.parse_end));
+    series_[ParseToDisplay].add(ms_between(timing.parse_end, displayed));
+}
+
+void LatencyStats::render(sf::RenderWindow& window) const
+{
+    if (not window.isOpen()) return;
+
+    const auto& font       = ResourceManager::instance().get_font();
+    const auto size        = window.getSize();
+    const float row_height = static_cast<float>(size.y) / static_cast<float>(StageCount);
+    const float bar_width  = static_cast<float>(size.x) / buckets;
+    // Leaves room for the label above the bars.
+    const float bar_height = row_height - 24;
+
+    sf::Text label;
+    label.setFont(font);
+    label.setCharacterSize(12);
+    sf::RectangleShape bar;
+    bar.setFillColor(sf::Color{200, 200, 200});
+
+    for (uint8_t stage = 0; stage < StageCount; stage++)
+    {
+        const auto& s   = series_[stage];
+        const float top = row_height * stage;
+
+        label.setString(summary(stage_name(static_cast<Stage>(stage)), s.size, s.p50, s.p99,
+                                s.max));
+        label.setPosition(4, top + 2);
+        window.draw(label);
+
+        const auto tallest = *std::max_element(s.histogram.begin(), s.histogram.end());
+        if (tallest == 0) continue;
+        for (size_t b = 0; b < buckets; b++)
+        {
+            const float h = bar_height * static_cast<float>(s.histogram[b]) / tallest;
+            bar.setSize({bar_width - 2, h});
+            bar.setPosition(bar_width * b + 1, top + row_height - 2 - h);
+            window.draw(bar);
+        }
+    }
+}
+
+void LatencyStats::debug() const
+{
+    const auto& logger = get_logger("LatencyStats");
+    logger.debug("Statuses recorded: ", recorded_, " (last ", window, " per stage)");
+    for (uint8_t stage = 0; stage < StageCount; stage++)
+    {
+        const auto& s = series_[stage];
+        std::string hist;
+        for (const auto count : s.histogram)
+        {
+            hist += std::to_string(count);
+            hist += ' ';
+        }
+        logger.debug(summary(stage_name(static_cast<Stage>(stage)), s.size, s.p50, s.p99, s.max),
+                     " | <1ms, 1, 2, 4 ... 2s+: ", hist);
+    }
+}
+} // namespace aa
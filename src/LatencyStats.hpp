@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Advancements.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace sf
+{
+class RenderWindow;
+}
+
+namespace aa
+{
+/* LatencyStats
+ * Where the time goes between the game writing an advancements file and us
+ * drawing the result. Every status that makes it to the screen gets recorded
+ * (see StatusTiming), one sample per stage, in a rolling window.
+ *
+ * render() draws a log2 histogram (in ms) per stage into a window, e.g. the
+ * Debug one. debug() logs the same thing, for the P key.
+ */
+struct LatencyStats
+{
+    enum Stage : uint8_t
+    {
+        WriteToDetect,
+        DetectToParse,
+        Parse,
+        ParseToDisplay,
+        Total,
+        StageCount,
+    };
+    static std::string_view stage_name(Stage stage);
+
+    // Last this many samples per stage.
+    static constexpr size_t window = 256;
+    // <1ms, 1-2ms, 2-4ms, ... 1-2s, 2s+.
+    static constexpr size_t buckets = 13;
+
+    // timing's status was drawn for the first time in the frame displayed at displayed.
+    // Ignored if the timing isn't known.
+    void record(const StatusTiming& timing, StatusTiming::clock::time_point displayed);
+
+    void render(sf::RenderWindow& window) const;
+    void debug() const;
+
+private:
+    struct Series
+    {
+        void add(double ms);
+
+        std::array<float, window> samples{};
+        // How many samples are in there, and where the next one goes.
+        size_t size = 0;
+        size_t next = 0;
+
+        // Recomputed on add(), so that drawing every frame doesn't cost anything.
+        std::array<uint32_t, buckets> histogram{};
+        float p50 = 0;
+        float p99 = 0;
+        float max = 0;
+    };
+
+    std::array<Series, StageCount> series_;
+    uint64_t recorded_ = 0;
+};
+} // namespace aa
@@ -0,0 +1,213 @@
+#include "ManifestCache.hpp"
+
+#include "BinaryCache.hpp"
+#include "ResourceManager.hpp"
+#include "logging.hpp"
+#include "mapped_file.hpp"
+
+#include <vector>
+
+namespace aa
+{
+namespace
+{
+using cache::StringRef;
+
+/* On-disk layout, see BinaryCache.
+ *
+ * [Header]
+ * [DirectoryRecord x directory_count]
+ * [AdvancementRecord x advancement_count]  <- in ordinal order
+ * [CriterionRecord x criteria_count]       <- in ordinal order
+ * [string data, strings_size bytes]
+ */
+constexpr char magic[8] = {'t', 'r', 'A', 'A', 'c', 'k', 'e', 'r'};
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t directory_count;
+    uint64_t manifest_hash;
+    uint64_t manifest_size;
+    uint32_t advancement_count;
+    uint32_t criteria_count;
+    uint64_t strings_size;
+};
+
+struct AdvancementRecord
+{
+    StringRef name;
+    StringRef category;
+    StringRef pretty_name;
+    StringRef short_name;
+    StringRef icon_path;
+    uint32_t criteria_begin;
+    uint32_t criteria_end;
+};
+
+struct CriterionRecord
+{
+    StringRef key;
+    StringRef icon_name;
+    uint32_t advancement;
+    uint32_t unused;
+};
+
+static_assert(sizeof(Header) == 48);
+static_assert(sizeof(AdvancementRecord) == 48);
+static_assert(sizeof(CriterionRecord) == 24);
+} // namespace
+
+std::optional<AdvancementManifest> ManifestCache::load(const std::string& cache_path,
+                                                       const std::string& manifest_path)
+{
+    using namespace cache;
+
+    auto& logger = get_logger("ManifestCache::load");
+
+    const MappedFile file{cache_path};
+    if (not file.valid())
+    {
+        logger.debug("No manifest cache at: ", cache_path);
+        return std::nullopt;
+    }
+
+    Reader r{file.view(), "manifest cache", cache_path, logger};
+    const auto header = r.header<Header>(magic, version);
+    if (not header.has_value()) return std::nullopt;
+
+    // Is it the same manifest? Hashing is way cheaper than parsing.
+    {
+        const MappedFile manifest_file{manifest_path};
+        if (not manifest_file.valid() || manifest_file.size() != header->manifest_size ||
+            fnv1a(manifest_file.view()) != header->manifest_hash)
+        {
+            logger.info("Manifest ", manifest_path, " changed since the cache was written.");
+            return std::nullopt;
+        }
+    }
+
+    if (not r.sized(header->directory_count * sizeof(DirectoryRecord) +
+                        header->advancement_count * sizeof(AdvancementRecord) +
+                        header->criteria_count * sizeof(CriterionRecord),
+                    header->strings_size))
+    {
+        return std::nullopt;
+    }
+
+    // Have any assets been added/removed/renamed?
+    Directories directories;
+    if (not r.directories(header->directory_count, directories)) return std::nullopt;
+
+    std::vector<AdvancementRecord> advancements(header->advancement_count);
+    for (auto& rec : advancements) rec = r.read<AdvancementRecord>();
+    std::vector<CriterionRecord> criteria(header->criteria_count);
+    for (auto& rec : criteria) rec = r.read<CriterionRecord>();
+    if (not r.ok) return std::nullopt;
+
+    auto& rm = ResourceManager::instance();
+
+    AdvancementManifest ret{};
+    ret.advancements.reserve(advancements.size());
+    ret.criteria.reserve(criteria.size());
+    for (const auto& rec : advancements)
+    {
+        auto* adv = ret.add_advancement(Advancement{r.str(rec.name), r.str(rec.category),
+                                                    r.str(rec.pretty_name),
+                                                    r.str(rec.short_name)});
+        // add_criterion only appends, so each advancement has to start where the last one ended.
+        if (adv == nullptr || rec.criteria_begin != ret.criteria.size() ||
+            rec.criteria_begin > rec.criteria_end || rec.criteria_end > criteria.size())
+        {
+            r.inconsistent();
+            return std::nullopt;
+        }
+
+        for (auto i = rec.criteria_begin; i < rec.criteria_end; i++)
+        {
+            auto icon_name = r.str(criteria[i].icon_name);
+            const auto it  = rm.criteria_map.find(icon_name);
+            if (it == rm.criteria_map.end())
+            {
+                logger.warning("Cached criterion texture ", icon_name, " no longer exists.");
+                return std::nullopt;
+            }
+            ret.add_criterion(*adv, r.str(criteria[i].key), std::move(icon_name), it->second);
+        }
+
+        adv->icon_path = r.str(rec.icon_path);
+        adv->icon      = rm.icon_at(adv->icon_path);
+    }
+
+    if (not r.ok || ret.criteria.size() != criteria.size())
+    {
+        r.inconsistent();
+        return std::nullopt;
+    }
+
+    logger.info("Loaded ", ret.advancements.size(), " advancements and ", ret.criteria.size(),
+                " criteria from cache: ", cache_path);
+    return ret;
+}
+
+bool ManifestCache::store(const std::string& cache_path, const std::string& manifest_path,
+                          const AdvancementManifest& manifest)
+{
+    using namespace cache;
+
+    auto& logger = get_logger("ManifestCache::store");
+
+    const MappedFile manifest_file{manifest_path};
+    if (not manifest_file.valid())
+    {
+        logger.error("Could not read manifest ", manifest_path, " to cache it.");
+        return false;
+    }
+
+    // The asset index already walked (or validated) every asset directory.
+    StringTable strings;
+    const auto directories =
+        directory_records(ResourceManager::assetIndex().directories, strings);
+
+    std::vector<AdvancementRecord> advancements;
+    advancements.reserve(manifest.advancements.size());
+    for (const auto& adv : manifest.advancements)
+    {
+        advancements.push_back(AdvancementRecord{
+            strings.add(adv.name), strings.add(adv.category), strings.add(adv.pretty_name),
+            strings.add(adv.short_name), strings.add(adv.icon_path), adv.criteria_begin,
+            adv.criteria_end});
+    }
+
+    std::vector<CriterionRecord> criteria;
+    criteria.reserve(manifest.criteria.size());
+    for (const auto& crit : manifest.criteria)
+    {
+        criteria.push_back(CriterionRecord{strings.add(crit.key), strings.add(crit.icon_name),
+                                           crit.advancement, 0});
+    }
+
+    auto header              = make_header<Header>(magic, version);
+    header.directory_count   = static_cast<uint32_t>(directories.size());
+    header.manifest_hash     = fnv1a(manifest_file.view());
+    header.manifest_size     = manifest_file.size();
+    header.advancement_count = static_cast<uint32_t>(advancements.size());
+    header.criteria_count    = static_cast<uint32_t>(criteria.size());
+    header.strings_size      = strings.data.size();
+
+    return write_atomically(cache_path,
+                            {bytes_of(header), bytes_of(directories), bytes_of(advancements),
+                             bytes_of(criteria), strings.data},
+                            "manifest cache", logger);
+}
+
+AdvancementManifest ManifestCache::load_or_parse(const std::string& manifest_path,
+                                                 const std::string& cache_path)
+{
+    return cache::load_or_build(
+        cache_path, [&] { return load(cache_path, manifest_path); },
+        [&] { return AdvancementManifest::from_file(manifest_path); },
+        [&](const AdvancementManifest& manifest) { store(cache_path, manifest_path, manifest); });
+}
+} // namespace aa
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Advancements.hpp"
+
+#include <optional>
+#include <string>
+
+namespace aa
+{
+/* ManifestCache
+ * A binary snapshot of a fully resolved AdvancementManifest: IDs, names,
+ * criteria (in order) and the icon each one resolved to. A warm start maps
+ * the cache instead of parsing advancements.json and walking every asset
+ * directory to resolve icons.
+ *
+ * The cache is only used if:
+ * - the format version matches,
+ * - advancements.json hashes to the same value it did when we wrote it,
+ * - every asset directory (recursively) has the same mtime it did back then.
+ *   Adding/removing/renaming any asset touches its directory, so this catches
+ *   everything except editing a file in place. Delete the cache for that.
+ */
+struct ManifestCache
+{
+    // Bump this whenever the on-disk layout (see ManifestCache.cpp) changes.
+    static constexpr uint32_t version = 1;
+
+    // nullopt if there is no cache, or it is stale/corrupt.
+    static std::optional<AdvancementManifest> load(const std::string& cache_path,
+                                                   const std::string& manifest_path);
+
+    // Returns false if the cache could not be written. Not fatal, just slower next time.
+    static bool store(const std::string& cache_path, const std::string& manifest_path,
+                      const AdvancementManifest& manifest);
+
+    // Loads from the cache if we can, otherwise parses manifest_path and refreshes
+    // the cache. An empty cache_path disables caching entirely.
+    static AdvancementManifest load_or_parse(const std::string& manifest_path,
+                                             const std::string& cache_path);
+};
+} // namespace aa
@@ -3,6 +3,7 @@
 #include "ConfigProvider.hpp"
 #include "logging.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <nlohmann/json.hpp>
 
@@ -38,14 +39,19 @@ OverlayManager::OverlayManager(AdvancementManifest& manifest)
 
     aa::conf::apply(config, "rate", [&](int rate) { setRate(static_cast<uint8_t>(rate)); });
 
+    // Icons are loaded as they scroll in. This is how far ahead of the window that is.
+    aa::conf::apply(config, "prefetch",
+                    [&](int64_t tiles)
+                    {
+                        prereqs.prefetch_ = tiles;
+                        reqs.prefetch_    = tiles;
+                    });
+
     get_logger("OverlayManager")
         .debug("Created OverlayManager. Current configuration:")
         .debug("Criteria Size: ", prereqs.get_size())
         .debug("Criteria Y: ", prereqs.yOffset_)
-        .debug("Advancements Y: ", reqs.yOffset_)
-        .debug("Now remapping textures as appropriate.");
-
-    remap_textures(manifest);
+        .debug("Advancements Y: ", reqs.yOffset_);
 
     // Okay, now to test out the new advancements setup.
     auto status = AdvancementStatus::from_default(manifest);
@@ -53,25 +59,25 @@ OverlayManager::OverlayManager(AdvancementManifest& manifest)
     reset_from_status(status);
 }
 
-void OverlayManager::remap_textures(AdvancementManifest& manifest)
+void OverlayManager::evict_unused()
 {
-    auto& rm = aa::ResourceManager::instance();
-    // This works for now :)
-
-    const auto crit_sz = prereqs.get_texture_size();
-    const auto adv_sz  = reqs.get_texture_size();
-    get_logger("OverlayManager")
-        .debug("Remapping all textures.")
-        .debug("Remapping criteria to size: ", crit_sz)
-        .debug("Remapping advancements to size: ", adv_sz);
-
-    for (auto& [_, advancement] : manifest.advancements)
+    // Icons are shared (between criteria, and between the two turntables if they
+    // happen to be the same size), so only evict what no tile of that size uses.
+    auto& icons = aa::ResourceManager::instance().icons;
+    std::vector<Icon> keep;
+    for (auto* table : {&reqs, &prereqs})
     {
-        advancement.icon = rm.remap_texture(advancement.icon, adv_sz);
-        for (auto& itr : advancement.criteria)
+        const auto size = table->get_texture_size();
+        keep.clear();
+        for (auto* other : {&reqs, &prereqs})
         {
-            itr.second = rm.remap_texture(itr.second, crit_sz);
+            if (other->get_texture_size() != size) continue;
+            for (const auto& tile : other->rb_.buf())
+            {
+                keep.push_back(tile.icon);
+            }
         }
+        icons.retain(keep, static_cast<uint32_t>(size));
     }
 }
 
@@ -86,38 +92,52 @@ void OverlayManager::reset_from_status(const AdvancementStatus& status)
     reqs.clear();
     prereqs.clear();
 
-    for (auto& [k, v] : status.incomplete)
-    {
-        reqs.emplace(v.pretty_name, v.icon);
-
-        for (auto loc : v.criteria_ordered)
+    // Tiles are identified by ordinal: advancement ordinals for reqs,
+    // criterion ordinals for prereqs. Both are emplaced in ordinal order, which
+    // handle_event relies on.
+    status.for_each_incomplete(
+        [&](const Advancement& adv)
         {
-            prereqs.emplace("", v.criteria.find(loc)->second);
-        }
-    }
+            reqs.emplace(adv.pretty_name, adv.icon, false, adv.ordinal);
+            status.for_each_remaining_criterion(
+                adv, [&](const Criterion& crit)
+                { prereqs.emplace("", crit.icon, false, crit.ordinal); });
+        });
+
+    // Whatever is done in this status (e.g. we switched instances) can go.
+    evict_unused();
 }
 
-void OverlayManager::reset_from_file(std::string_view filename,
-                                         const AdvancementManifest& manifest)
+void OverlayManager::handle_event(StatusUpdate update)
 {
-    // Okay, now to test out the new advancements setup.
-    auto status = AdvancementStatus::from_file(filename, manifest);
-
-    get_logger("OverlayManager")
-        .debug("Resetting from advancements.json manifest given file ", filename);
+    if (update.delta == nullptr || update.delta->reset)
+    {
+        get_logger("OverlayManager").debug("Resetting from new status.");
+        reset_from_status(*update.new_status);
+        return;
+    }
 
-    // This can handle errors, we assume that sometimes we get a bad file.
-    reset_from_status(status);
-}
+    // Deltas are tiny (usually a single advancement or criterion), and tiles are
+    // sorted by ordinal (see reset_from_status), so look up just those tiles.
+    const auto& delta    = *update.delta;
+    const auto& manifest = *update.new_status->manifest;
 
-void OverlayManager::reset(const AdvancementManifest& manifest)
-{
-    // Okay, now to test out the new advancements setup.
-    auto status = AdvancementStatus::from_default(manifest);
+    const auto removed_reqs = reqs.erase_ids(delta.completed);
 
-    get_logger("OverlayManager").debug("Resetting from advancements.json manifest.");
+    // Criteria of newly completed advancements aren't in the delta, they're implied.
+    std::vector<uint32_t> criteria = delta.criteria;
+    for (const auto ordinal : delta.completed)
+    {
+        const auto& adv = manifest.advancements[ordinal];
+        for (auto i = adv.criteria_begin; i < adv.criteria_end; i++) criteria.push_back(i);
+    }
+    std::sort(criteria.begin(), criteria.end());
+    const auto removed_prereqs = prereqs.erase_ids(criteria);
+    if (removed_reqs + removed_prereqs != 0) evict_unused();
 
-    reset_from_status(status);
+    get_logger("OverlayManager")
+        .debug("Applied status delta: removed ", removed_reqs, " advancement tile(s) and ",
+               removed_prereqs, " criteria tile(s).");
 }
 
 void OverlayManager::debug()
@@ -126,5 +146,6 @@ void OverlayManager::debug()
 
     logger.debug("Major requirements buffer size: ", reqs.rb_.buf().size());
     logger.debug("Pre-requirements buffer size: ", prereqs.rb_.buf().size());
+    aa::ResourceManager::instance().icons.debug();
 }
 } // namespace aa
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "TurnTable.hpp"
 #include "ResourceManager.hpp"
 #include "Advancements.hpp"
+#include "Event.hpp"
 #include "utilities.hpp"
 
 #include <nlohmann/json_fwd.hpp>
@@ -33,7 +34,7 @@ struct OverlayCriteria {
     std::string icon;
 };
 
-struct OverlayManager
+struct OverlayManager : EventHandler
 {
     TurnTable prereqs;
     TurnTable reqs;
@@ -44,12 +45,13 @@ struct OverlayManager
 
     OverlayManager(AdvancementManifest& manifest);
 
-    // assumes manifest is in advancements.json atm
-    void reset_from_file(std::string_view filename, const AdvancementManifest& manifest);
-
+    // Full rebuild of both turntables.
     void reset_from_status(const AdvancementStatus& status);
 
-    void reset(const AdvancementManifest& manifest);
+    // Applies the delta if there is one, otherwise does a full rebuild. Finding the
+    // tiles to remove is a binary search per change. If any were removed, their
+    // icons are evicted, which does walk the tiles (see evict_unused).
+    void handle_event(StatusUpdate update) override;
 
     void debug();
 
@@ -61,10 +63,16 @@ struct OverlayManager
 
     void render(sf::RenderWindow& win)
     {
+        auto& icons = aa::ResourceManager::instance().icons;
+        // Whatever finished loading since last frame. Never waits for the rest.
+        icons.upload_finished();
+        // One clock for every animated icon, on both turntables.
+        icons.animate(AnimatedIcons::clock::now());
         prereqs.animateDraw(win);
         reqs.animateDraw(win);
     }
 
-    void remap_textures(AdvancementManifest& manifest);
+    // Evicts the icons of everything that's no longer on either turntable.
+    void evict_unused();
 };
 }  // namespace aa
@@ -0,0 +1,58 @@
+#include "PollScheduler.hpp"
+
+#include "ConfigProvider.hpp"
+#include "logging.hpp"
+
+#include <algorithm>
+
+namespace aa
+{
+PollScheduler::Options PollScheduler::Options::from_config()
+{
+    if (aa::conf::get().contains("poll_interval"))
+    {
+        // Counted in frames, which don't map to any fixed time. Don't guess.
+        get_logger("PollScheduler")
+            .warning("\"poll_interval\" is no longer used, and is ignored. Use \"poll_min_ms\" "
+                     "and \"poll_max_ms\" (in milliseconds) instead.");
+    }
+
+    Options ret;
+    ret.min = std::chrono::milliseconds{
+        aa::conf::get_or(aa::conf::get(), "poll_min_ms", static_cast<uint64_t>(ret.min.count()))};
+    ret.max = std::chrono::milliseconds{
+        aa::conf::get_or(aa::conf::get(), "poll_max_ms", static_cast<uint64_t>(ret.max.count()))};
+    return ret;
+}
+
+PollScheduler::PollScheduler(Options options) : options_(options), interval_(options.min)
+{
+    if (options_.min.count() <= 0 || options_.max < options_.min)
+    {
+        get_logger("PollScheduler")
+            .fatal_error("Invalid poll interval: poll_min_ms must be 1 or above, and "
+                         "poll_max_ms must be at least poll_min_ms.");
+    }
+}
+
+void PollScheduler::polled(clock::time_point now, bool activity) noexcept
+{
+    polls_ += 1;
+    if (activity)
+    {
+        active_polls_ += 1;
+        interval_ = options_.min;
+    }
+    else
+    {
+        interval_ = std::min(interval_ * 2, options_.max);
+    }
+    next_ = now + interval_;
+}
+
+void PollScheduler::wake(clock::time_point now) noexcept
+{
+    interval_ = options_.min;
+    next_     = now;
+}
+} // namespace aa
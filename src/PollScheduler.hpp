@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace aa
+{
+/* PollScheduler
+ * Decides when to poll the filesystem, by the clock rather than by frame count
+ * (so loop-sleep, vsync and slow frames don't change how often we look).
+ *
+ * Right after something happened, we poll at the fastest rate: more is likely to
+ * follow (the game saves in bursts, a focus switch is followed by a world load).
+ * Every poll that finds nothing doubles the interval, up to a maximum, so a paused
+ * or unfocused game costs (almost) nothing.
+ */
+struct PollScheduler
+{
+    using clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        std::chrono::milliseconds min{100};
+        std::chrono::milliseconds max{3000};
+
+        // From "poll_min_ms" and "poll_max_ms".
+        static Options from_config();
+    };
+
+    explicit PollScheduler(Options options);
+
+    bool due(clock::time_point now) const noexcept { return now >= next_; }
+
+    // Call after every poll that due() allowed. activity == it found something.
+    void polled(clock::time_point now, bool activity) noexcept;
+
+    // Something happened that we didn't poll for (a focus switch, a change
+    // notification...). Poll right away, and quickly for a while.
+    void wake(clock::time_point now) noexcept;
+
+    std::chrono::milliseconds interval() const noexcept { return interval_; }
+    const Options& options() const noexcept { return options_; }
+    uint64_t polls() const noexcept { return polls_; }
+    // Polls that found something.
+    uint64_t active_polls() const noexcept { return active_polls_; }
+
+private:
+    Options options_;
+    std::chrono::milliseconds interval_;
+    // Default constructed == the epoch, so the very first call is always due.
+    clock::time_point next_{};
+
+    uint64_t polls_        = 0;
+    uint64_t active_polls_ = 0;
+};
+} // namespace aa
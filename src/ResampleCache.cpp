@@ -0,0 +1,135 @@
+#include "ResampleCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace aa
+{
+ResampleCache::Pixels ResampleCache::resample(const uint8_t* pixels, uint32_t w, uint32_t h,
+                                              uint32_t size)
+{
+    constexpr size_t channels = 4;
+    Pixels out(size_t{size} * size * channels);
+    if (w == 0 || h == 0 || size == 0) return out;
+
+    // Which source rows/columns end up in destination row/column i: [span[i], span[i + 1]).
+    // Worked out once, rather than per pixel.
+    const auto spans = [&](uint32_t from)
+    {
+        std::vector<uint32_t> span(size + 1);
+        for (uint32_t i = 0; i <= size; i++)
+        {
+            span[i] = static_cast<uint32_t>(uint64_t{i} * from / size);
+        }
+        return span;
+    };
+    const auto xs = spans(w);
+    const auto ys = spans(h);
+
+    if (w <= size && h <= size)
+    {
+        // Scaling up: nearest neighbour. Integer factors (16 -> 48 and so on) repeat
+        // whole rows, so copy those instead of working them out again.
+        for (uint32_t y = 0; y < size; y++)
+        {
+            auto* dst = out.data() + size_t{y} * size * channels;
+            if (y != 0 && ys[y] == ys[y - 1])
+            {
+                std::memcpy(dst, dst - size * channels, size * channels);
+                continue;
+            }
+            const auto* row = pixels + size_t{ys[y]} * w * channels;
+            for (uint32_t x = 0; x < size; x++)
+            {
+                std::memcpy(dst + x * channels, row + xs[x] * channels, channels);
+            }
+        }
+        return out;
+    }
+
+    // Scaling down: average every source pixel that lands in the destination one.
+    // Colours are weighted by alpha, so that transparent pixels (which are usually
+    // black) don't darken the edges.
+    for (uint32_t y = 0; y < size; y++)
+    {
+        const auto y0 = ys[y];
+        const auto y1 = std::max(ys[y + 1], y0 + 1);
+        auto* dst     = out.data() + size_t{y} * size * channels;
+        for (uint32_t x = 0; x < size; x++)
+        {
+            const auto x0 = xs[x];
+            const auto x1 = std::max(xs[x + 1], x0 + 1);
+
+            uint32_t r = 0, g = 0, b = 0, a = 0;
+            for (auto sy = y0; sy < y1; sy++)
+            {
+                const auto* p = pixels + (size_t{sy} * w + x0) * channels;
+                for (auto sx = x0; sx < x1; sx++, p += channels)
+                {
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    a += p[3];
+                }
+            }
+
+            // Fully transparent. Already zeroed.
+            if (a == 0) continue;
+
+            const auto n = (x1 - x0) * (y1 - y0);
+            auto* d      = dst + x * channels;
+            d[0]         = static_cast<uint8_t>(r / a);
+            d[1]         = static_cast<uint8_t>(g / a);
+            d[2]         = static_cast<uint8_t>(b / a);
+            d[3]         = static_cast<uint8_t>((a + n / 2) / n);
+        }
+    }
+    return out;
+}
+
+const ResampleCache::Pixels* ResampleCache::find(uint64_t key)
+{
+    const auto it = entries_.find(key);
+    if (it == entries_.end())
+    {
+        misses_ += 1;
+        return nullptr;
+    }
+    hits_ += 1;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &it->second->second;
+}
+
+const ResampleCache::Pixels& ResampleCache::insert(uint64_t key, Pixels pixels)
+{
+    if (const auto it = entries_.find(key); it != entries_.end())
+    {
+        bytes_ -= it->second->second.size();
+        lru_.erase(it->second);
+        entries_.erase(it);
+    }
+
+    bytes_ += pixels.size();
+    lru_.emplace_front(key, std::move(pixels));
+    entries_.emplace(key, lru_.begin());
+    trim();
+    return lru_.front().second;
+}
+
+void ResampleCache::set_budget(size_t bytes)
+{
+    budget_ = bytes;
+    trim();
+}
+
+void ResampleCache::trim()
+{
+    while (bytes_ > budget_ && lru_.size() > 1)
+    {
+        const auto& [key, pixels] = lru_.back();
+        bytes_ -= pixels.size();
+        entries_.erase(key);
+        lru_.pop_back();
+    }
+}
+} // namespace aa
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace aa
+{
+/* ResampleCache
+ * Icons scaled to the size they get drawn at, as plain RGBA pixels, so that
+ * making an icon resident again (after it was evicted, or at another turntable
+ * size) doesn't mean decoding and scaling it all over again. Keyed by whatever
+ * the caller uses for (source, size) - IconStore uses the same key as for
+ * residency. AnimatedIcons keeps its decoded frames in one too.
+ *
+ * Bounded by a byte budget. Whatever was used least recently goes first.
+ * Main thread only; resample() itself is fine anywhere.
+ */
+struct ResampleCache
+{
+    // size x size, RGBA, row major.
+    using Pixels = std::vector<uint8_t>;
+
+    // Scales w x h RGBA pixels to size x size. Nearest neighbour when scaling up
+    // (these are pixel art, blurring them would be wrong), and an alpha-weighted
+    // box filter when scaling down.
+    static Pixels resample(const uint8_t* pixels, uint32_t w, uint32_t h, uint32_t size);
+
+    // nullptr on a miss. Counts towards hits()/misses().
+    const Pixels* find(uint64_t key);
+
+    // Evicts least recently used entries until the budget fits again, but never the
+    // one we just inserted.
+    const Pixels& insert(uint64_t key, Pixels pixels);
+
+    void set_budget(size_t bytes);
+
+    size_t bytes() const noexcept { return bytes_; }
+    size_t budget() const noexcept { return budget_; }
+    size_t size() const noexcept { return entries_.size(); }
+    uint64_t hits() const noexcept { return hits_; }
+    uint64_t misses() const noexcept { return misses_; }
+
+private:
+    void trim();
+
+    // Most recently used first.
+    std::list<std::pair<uint64_t, Pixels>> lru_;
+    std::unordered_map<uint64_t, decltype(lru_)::iterator> entries_;
+
+    // A few MB is every icon at a couple of sizes.
+    size_t budget_   = 4 << 20;
+    size_t bytes_    = 0;
+    uint64_t hits_   = 0;
+    uint64_t misses_ = 0;
+};
+} // namespace aa
@@ -1,15 +1,16 @@
 #pragma once
 
+#include "AssetIndex.hpp"
 #include "utilities.hpp"
 #include "logging.hpp"
 #include "compat.hpp"
+#include "IconStore.hpp"
 
-#include <SFML/Graphics/Texture.hpp>
-#include <SFML/Graphics/RenderTexture.hpp>
+#include <array>
 #include <memory>
 #include <string>
 
-namespace sf { class Font; }
+namespace sf { class Drawable; class Font; }
 
 namespace aa
 {
@@ -48,8 +49,18 @@ inline std::pair<std::string, std::string> basic_string_splitter(std::string_vie
 
 struct ResourceManager
 {
+    // Every directory getAllAssets searches (recursively), in priority order.
+    static constexpr std::array<const char*, 3> asset_roots{
+        "assets/inject/", "assets/sprites/global/", "assets/sprites/gif/"};
+
     static ResourceManager& instance();
-    static std::unordered_map<std::string, std::string> getAllAssets();
+    // Built (or loaded) once, on first use. See AssetIndex.
+    static const AssetIndex& assetIndex();
+    // Asset name -> file.
+    static const std::unordered_map<std::string, std::string>& getAllAssets()
+    {
+        return assetIndex().assets;
+    }
     static std::string assetName(std::string filePath)
     {
         aa::normalize_path(filePath);
@@ -64,42 +75,31 @@ struct ResourceManager
         if (it == filePath.crend()) return filePath;
         return std::string{it.base(), filePath.cend()};
     }
+    // Registers every criteria icon we know about. Doesn't load any of them.
     void loadAllCriteria();
 
     static sf::Drawable& basic_marker(float radius, float x, float y);
 
     void commit() { no_load = true; }
 
-    /* Literally just jams a texture into a vector of unique pointers. */
-    const sf::Texture* store_texture_at(std::string path)
-    {
-        random_textures.emplace_back(std::make_unique<sf::Texture>());
-        random_textures.back()->loadFromFile(path);
-        return random_textures.back().get();
-    }
+    /* No longer loads anything - see IconStore. */
+    Icon icon_at(std::string path) { return icons.intern(std::move(path)); }
 
     const sf::Font& get_font();
 
-    const sf::Texture* remap_texture(const sf::Texture* base, uint64_t new_size);
-
-    std::vector<std::unique_ptr<sf::Texture>> random_textures;
-    std::vector<std::unique_ptr<sf::RenderTexture>> random_rerenders;
+    // Every advancement and criteria icon. Loaded lazily, at whatever size they
+    // get drawn at.
+    IconStore icons;
 
-    // unused atm
-    std::unordered_map<std::string, std::unordered_map<std::string, sf::Texture>> criteria;
-    // use this for now
-    std::unordered_map<std::string, sf::Texture> test_criteria;
+    // unused atm. Category -> name -> icon.
+    std::unordered_map<std::string, string_map<Icon>> criteria;
 
     // actually use this lol!
-    string_map<std::unique_ptr<sf::Texture>> criteria_map;
+    string_map<Icon> criteria_map;
 
 private:
-    ResourceManager() { loadAllCriteria(); }
+    ResourceManager();
     ~ResourceManager();
-    void loadCriteria(std::string, std::string);
-    // IMPLEMENTATION DETAIL DON'T LOOK IT IS VERY BAD :)
-    // later: wtf
-    std::unordered_map<std::string, sf::Texture>* current_ = nullptr;
-    bool no_load                                           = false;
+    bool no_load = false;
 };
 } // namespace aa
\ No newline at end of file
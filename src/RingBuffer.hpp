@@ -34,6 +34,61 @@ struct RingBuffer
 
     auto size() const noexcept { return buf_.size(); }
 
+    // Removes every element matching pred, without moving the view: whatever was
+    // at pos_ (or the next surviving element) stays at pos_. Returns # removed.
+    template <typename Pred>
+    size_type erase_if(Pred&& pred)
+    {
+        size_type before_pos = 0;
+        size_type out        = 0;
+        for (size_type i = 0; i < buf_.size(); i++)
+        {
+            if (pred(buf_[i]))
+            {
+                if (i < pos_) before_pos += 1;
+                continue;
+            }
+            if (out != i) buf_[out] = std::move(buf_[i]);
+            out += 1;
+        }
+
+        const auto removed = buf_.size() - out;
+        buf_.erase(buf_.begin() + out, buf_.end());
+
+        pos_ -= before_pos;
+        if (pos_ >= size()) pos_ = 0;
+        return removed;
+    }
+
+    // Same, for the elements at positions (indexes into buf_, ascending). Only the
+    // elements after the first removed one get moved.
+    size_type erase_at(const std::vector<size_type>& positions)
+    {
+        if (positions.empty()) return 0;
+
+        size_type before_pos = 0;
+        size_type out        = positions.front();
+        size_type next       = 0;
+        for (size_type i = positions.front(); i < buf_.size(); i++)
+        {
+            if (next < positions.size() && positions[next] == i)
+            {
+                if (i < pos_) before_pos += 1;
+                next += 1;
+                continue;
+            }
+            buf_[out] = std::move(buf_[i]);
+            out += 1;
+        }
+
+        const auto removed = buf_.size() - out;
+        buf_.erase(buf_.begin() + out, buf_.end());
+
+        pos_ -= before_pos;
+        if (pos_ >= size()) pos_ = 0;
+        return removed;
+    }
+
     std::vector<T> buf_;
 };
 }  // namespace aa
@@ -0,0 +1,307 @@
+#include "StatusParser.hpp"
+
+#include "ConfigProvider.hpp"
+#include "logging.hpp"
+
+#include <utility>
+
+namespace aa
+{
+namespace
+{
+// The game writes whole objects. Anything else is a write in progress.
+bool looks_whole(std::string_view contents)
+{
+    const auto first = contents.find_first_not_of(" \t\r\n");
+    const auto last  = contents.find_last_not_of(" \t\r\n");
+    return first != std::string_view::npos && contents[first] == '{' && contents[last] == '}';
+}
+
+// Worlds come and go (one per reset), so don't remember every file ever parsed.
+constexpr size_t max_fingerprints = 16;
+} // namespace
+
+StatusParser::Options StatusParser::Options::from_config()
+{
+    Options ret;
+    ret.partial_wait = std::chrono::milliseconds{aa::conf::get_or(
+        aa::conf::get(), "debounce_ms", static_cast<uint64_t>(ret.partial_wait.count()))};
+    ret.partial_retries =
+        aa::conf::get_or(aa::conf::get(), "debounce_retries", ret.partial_retries);
+    return ret;
+}
+
+StatusParser::StatusParser(const AdvancementManifest& manifest) : StatusParser(manifest, Options{})
+{
+}
+
+StatusParser::StatusParser(const AdvancementManifest& manifest, Options options)
+    : manifest_(manifest), options_(options), logger_(&get_logger("StatusParser")),
+      worker_([this] { run(); })
+{
+}
+
+StatusParser::~StatusParser()
+{
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+StatusParser::Slot& StatusParser::slot_locked(uint32_t key)
+{
+    if (key >= slots_.size())
+    {
+        slots_.resize(key + 1);
+    }
+    return slots_[key];
+}
+
+void StatusParser::request(std::string filename, uint32_t key)
+{
+    {
+        std::lock_guard lock{mutex_};
+        auto& slot = slot_locked(key);
+        if (slot.pending.has_value())
+        {
+            // Never even got started. Still counts.
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            pending_count_ += 1;
+        }
+        slot.pending   = std::move(filename);
+        slot.requested = StatusTiming::clock::now();
+        slot.generation += 1;
+    }
+    wake_.notify_one();
+}
+
+void StatusParser::cancel()
+{
+    std::lock_guard lock{mutex_};
+    for (auto& slot : slots_)
+    {
+        if (slot.pending.has_value())
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            slot.pending.reset();
+        }
+        // Whatever is in flight now belongs to an old generation, and gets dropped.
+        slot.generation += 1;
+        slot.delivered.clear();
+    }
+    pending_count_ = 0;
+}
+
+std::optional<AdvancementStatus> StatusParser::take_locked(Slot& slot)
+{
+    if (not slot.front.has_value())
+    {
+        return std::nullopt;
+    }
+    if (slot.front_generation != slot.generation)
+    {
+        // Finished, but something newer was requested in the meantime.
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        slot.front.reset();
+        return std::nullopt;
+    }
+    return std::exchange(slot.front, std::nullopt);
+}
+
+std::optional<AdvancementStatus> StatusParser::take(uint32_t key)
+{
+    std::lock_guard lock{mutex_};
+    if (key >= slots_.size())
+    {
+        return std::nullopt;
+    }
+    return take_locked(slots_[key]);
+}
+
+std::vector<StatusParser::Finished> StatusParser::take_all()
+{
+    std::vector<Finished> ret;
+    std::lock_guard lock{mutex_};
+    for (size_t key = 0; key < slots_.size(); key++)
+    {
+        if (auto status = take_locked(slots_[key]); status.has_value())
+        {
+            ret.push_back({static_cast<uint32_t>(key), std::move(*status)});
+        }
+    }
+    return ret;
+}
+
+void StatusParser::run()
+{
+    std::unique_lock lock{mutex_};
+    while (true)
+    {
+        wake_.wait(lock, [this] { return stop_ || pending_count_ > 0; });
+        if (stop_) return;
+
+        // Round robin over the keys. There is at least one pending.
+        size_t key = next_slot_ % slots_.size();
+        while (not slots_[key].pending.has_value())
+        {
+            key = (key + 1) % slots_.size();
+        }
+        next_slot_ = key + 1;
+        pending_count_ -= 1;
+
+        auto filename     = std::exchange(slots_[key].pending, std::nullopt).value();
+        const auto my_gen = slots_[key].generation;
+
+        StatusTiming timing;
+        timing.detected = slots_[key].requested;
+
+        // Don't hold the lock while we do I/O, that's the whole point.
+        lock.unlock();
+        logger_->debug("Parsing ", filename, " (key ", key, ", generation ", my_gen, ")");
+        timing.parse_start = StatusTiming::clock::now();
+        {
+            // Not every standard library can convert file_clock to anything yet, but
+            // "how long ago" works everywhere.
+            namespace fs = std::filesystem;
+            std::error_code ec;
+            const auto mtime = fs::last_write_time(filename, ec);
+            if (not ec)
+            {
+                const auto age = fs::file_time_type::clock::now() - mtime;
+                timing.written = timing.parse_start -
+                                 std::chrono::duration_cast<StatusTiming::clock::duration>(age);
+            }
+        }
+        bool unchanged = false;
+        auto back      = load(key, filename, my_gen, lock, unchanged);
+        timing.parse_end = StatusTiming::clock::now();
+        lock.lock();
+        if (stop_) return;
+
+        // slots_ may have grown while we were parsing, so no references across that.
+        auto& slot = slots_[key];
+        if (not back.has_value() || my_gen != slot.generation)
+        {
+            logger_->debug("Dropping stale parse of ", filename, " (generation ", my_gen,
+                           ", now at ", slot.generation, ")");
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (unchanged)
+        {
+            parses_avoided_.fetch_add(1, std::memory_order_relaxed);
+            if (slot.delivered == filename)
+            {
+                // Nothing the main loop doesn't have already. If it hasn't taken it
+                // yet, that's still the right status, so keep it current.
+                logger_->debug("Skipping unchanged rewrite of ", filename);
+                if (slot.front.has_value()) slot.front_generation = my_gen;
+                continue;
+            }
+            logger_->debug("Unchanged since we last parsed it: ", filename);
+        }
+
+        // Swap the back buffer in. If the main loop never took the previous front,
+        // it's older than this one anyway.
+        back->meta.timing = timing;
+        slot.front.emplace(std::move(*back));
+        slot.front_generation = my_gen;
+        slot.delivered        = std::move(filename);
+    }
+}
+
+std::optional<AdvancementStatus> StatusParser::load(uint32_t key, const std::string& filename,
+                                                    uint64_t generation,
+                                                    std::unique_lock<std::mutex>& lock,
+                                                    bool& unchanged)
+{
+    namespace fs = std::filesystem;
+
+    if (key >= fingerprints_.size()) fingerprints_.resize(key + 1);
+    auto& prints = fingerprints_[key];
+    auto it      = prints.find(filename);
+
+    // min() never matches, so a file we can't stat is always read.
+    const auto stat_mtime = [&]
+    {
+        std::error_code ec;
+        const auto mtime = fs::last_write_time(filename, ec);
+        return ec ? fs::file_time_type::min() : mtime;
+    };
+
+    // Stat first: if the game hasn't touched the file at all, don't even read it.
+    // If it changes between the stat and the read, the next mtime won't match.
+    auto mtime = stat_mtime();
+    if (it != prints.end() && mtime != fs::file_time_type::min() && it->second.mtime == mtime)
+    {
+        std::error_code ec;
+        if (const auto size = fs::file_size(filename, ec); not ec && size == it->second.size)
+        {
+            unchanged = true;
+            return it->second.status;
+        }
+    }
+
+    bool read = buffer_.read(filename);
+    for (uint32_t retries = 0; read && not looks_whole(buffer_.view()); retries++)
+    {
+        if (retries == options_.partial_retries)
+        {
+            logger_->debug("Gave up waiting for ", filename, " (partial)");
+            break;
+        }
+        // Wakes up early for a newer request, which makes this one moot.
+        lock.lock();
+        const bool superseded = wake_.wait_for(
+            lock, options_.partial_wait,
+            [&] { return stop_ || slots_[key].generation != generation; });
+        lock.unlock();
+        if (superseded) return std::nullopt;
+
+        mtime = stat_mtime();
+        read  = buffer_.read(filename);
+    }
+    if (not read)
+    {
+        // Let from_file deal with (and complain about) it.
+        prints.erase(filename);
+        return AdvancementStatus::from_file(filename, manifest_);
+    }
+
+    // Most real changes (new criteria) change the size, the hash is there for the
+    // ones that don't.
+    const auto contents = buffer_.view();
+    const auto hash     = fnv1a(contents);
+    if (it != prints.end() && it->second.size == contents.size() && it->second.hash == hash)
+    {
+        it->second.mtime = mtime;
+        unchanged        = true;
+        return it->second.status;
+    }
+
+    auto status = AdvancementStatus::from_contents(contents, manifest_);
+    if (it == prints.end() && prints.size() >= max_fingerprints) prints.clear();
+    prints.insert_or_assign(filename, Fingerprint{contents.size(), mtime, hash, status});
+    return status;
+}
+
+void StatusParser::debug() const
+{
+    std::lock_guard lock{mutex_};
+    for (size_t key = 0; key < slots_.size(); key++)
+    {
+        const auto& slot = slots_[key];
+        logger_->debug("Key ", key, ": generation: ", slot.generation,
+                       ", pending: ", slot.pending.has_value(),
+                       ", ready: ", slot.front.has_value());
+    }
+    logger_->debug("Dropped: ", dropped(), ", avoided by the fingerprints: ", parses_avoided());
+}
+} // namespace aa
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Advancements.hpp"
+#include "file_buffer.hpp"
+#include "utilities.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aa
+{
+struct Logger;
+
+/* StatusParser
+ * Parses advancements files on a background thread, so that a slow disk (or a
+ * huge file) never stalls the render loop.
+ *
+ * Double buffered: the worker parses into its own (back) status, then swaps it
+ * into the shared front slot under a lock. The main loop calls take() once per
+ * frame and swaps the front slot out, so handing over a status is two moves.
+ *
+ * Every request gets a generation. Only the newest generation is ever handed out;
+ * anything older that finishes late (or is still queued) is dropped, because a
+ * newer file event already made it stale.
+ *
+ * Requests are keyed (e.g. by instance), and generations are per key: a newer
+ * file from one instance doesn't make another instance's file stale.
+ *
+ * The worker also keeps a fingerprint (size, mtime, hash) of every file it has
+ * parsed, per key. Rewrites that didn't change a single byte (autosaves...) are
+ * never parsed again: they're dropped, or, if the key has moved on to another
+ * file since, answered with the status we already have for them.
+ */
+struct StatusParser
+{
+    struct Options
+    {
+        // A file that isn't a whole JSON object was caught mid-write. It is read
+        // again after partial_wait, at most partial_retries times, then parsed as is.
+        std::chrono::milliseconds partial_wait{100};
+        uint32_t partial_retries = 5;
+
+        // From "debounce_ms" and "debounce_retries", like CurrentFileProvider::Debounce.
+        static Options from_config();
+    };
+
+    explicit StatusParser(const AdvancementManifest& manifest);
+    StatusParser(const AdvancementManifest& manifest, Options options);
+    // Waits for whatever is in flight, then joins the worker.
+    ~StatusParser();
+
+    StatusParser(const StatusParser&)            = delete;
+    StatusParser& operator=(const StatusParser&) = delete;
+
+    // Queues filename for parsing. Supersedes anything queued or in flight for key.
+    void request(std::string filename, uint32_t key = 0);
+
+    // Drops everything queued/in flight (for every key), e.g. when the status is
+    // reset by hand.
+    void cancel();
+
+    // Call at a frame boundary. Returns the newest finished status for key, if any.
+    std::optional<AdvancementStatus> take(uint32_t key = 0);
+
+    struct Finished
+    {
+        uint32_t key;
+        AdvancementStatus status;
+    };
+    // Same, for every key at once. Empty (and allocation free) most frames.
+    std::vector<Finished> take_all();
+
+    // How many parses were thrown away because something newer came along.
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    // How many requests the fingerprints answered without parsing anything.
+    uint64_t parses_avoided() const noexcept
+    {
+        return parses_avoided_.load(std::memory_order_relaxed);
+    }
+
+    void debug() const;
+
+private:
+    struct Slot
+    {
+        // The next file to parse, if the worker hasn't picked it up yet.
+        std::optional<std::string> pending;
+        // When it was requested. Callers request as soon as poll() reports a file,
+        // so this is the detection time as far as StatusTiming is concerned.
+        StatusTiming::clock::time_point requested{};
+        // Generation of the newest request (or cancel).
+        uint64_t generation = 0;
+
+        // The front buffer, and the generation it was parsed for.
+        std::optional<AdvancementStatus> front;
+        uint64_t front_generation = 0;
+        // The file front came from. Cleared by cancel(), so that an unchanged file
+        // is handed out again after that.
+        std::string delivered;
+    };
+
+    // Worker only. What we last parsed out of a file, and how to tell it apart.
+    struct Fingerprint
+    {
+        uint64_t size = 0;
+        std::filesystem::file_time_type mtime{};
+        uint64_t hash = 0;
+        AdvancementStatus status;
+    };
+
+    void run();
+    // Called by the worker, without the lock. Reads and parses filename, unless
+    // its fingerprint says we already have it (sets unchanged). nullopt if key got
+    // a newer request (or we're stopping) while waiting out a partial write.
+    std::optional<AdvancementStatus> load(uint32_t key, const std::string& filename,
+                                          uint64_t generation, std::unique_lock<std::mutex>& lock,
+                                          bool& unchanged);
+    // Requires mutex_. Hands out front if it is current, drops it otherwise.
+    std::optional<AdvancementStatus> take_locked(Slot& slot);
+    Slot& slot_locked(uint32_t key);
+
+    const AdvancementManifest& manifest_;
+    const Options options_;
+    Logger* logger_;
+
+    // Only ever touched by the worker. Indexed by key, then path.
+    std::vector<string_map<Fingerprint>> fingerprints_;
+    FileBuffer buffer_;
+
+    // Everything below (except the counters) is guarded by mutex_.
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+
+    // Indexed by key. Keys are small (instance numbers), so this stays tiny.
+    std::vector<Slot> slots_;
+    // How many slots have something pending, so the worker doesn't have to look.
+    size_t pending_count_ = 0;
+    // Where the worker looks first next time, so one busy key can't starve the rest.
+    size_t next_slot_ = 0;
+
+    bool stop_ = false;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> parses_avoided_{0};
+
+    // Last, so that everything above exists before the worker starts.
+    std::thread worker_;
+};
+} // namespace aa
@@ -0,0 +1,126 @@
+#include "TextureAtlas.hpp"
+
+#include "logging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace aa
+{
+TextureAtlas::Page& TextureAtlas::new_page(uint32_t size, size_t count)
+{
+    auto& logger = get_logger("TextureAtlas");
+
+    const auto cell = size + gutter;
+    // Keep pages reasonably small even on drivers that allow huge textures.
+    const auto max_side = std::min(sf::Texture::getMaximumSize(), 4096u);
+    if (cell > max_side)
+    {
+        logger.fatal_error("Cannot fit icons of size ", size, " in a texture of at most ",
+                           max_side, "x", max_side, ".");
+    }
+
+    // Square-ish grid, just big enough for count.
+    const auto wanted  = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const auto columns = std::clamp(wanted, 1u, max_side / cell);
+    const auto rows    = std::clamp(static_cast<uint32_t>((count + columns - 1) / columns), 1u,
+                                    max_side / cell);
+
+    const auto w = columns * cell;
+    const auto h = rows * cell;
+    auto texture = std::make_unique<sf::Texture>();
+    if (not texture->create(w, h))
+    {
+        logger.fatal_error("Failed to create an atlas page of size ", w, "x", h, "!");
+    }
+    // New textures are undefined, and the gutters never get written to otherwise.
+    const std::vector<uint8_t> transparent(size_t{w} * h * 4);
+    texture->update(transparent.data(), w, h, 0, 0);
+    bytes_ += transparent.size();
+
+    logger.debug("Created atlas page ", pages_.size(), ": ", columns, "x", rows, " cells of ",
+                 size, "px.");
+    return pages_.emplace_back(Page{std::move(texture), size, columns, columns * rows});
+}
+
+TextureAtlas::Region TextureAtlas::insert(const uint8_t* pixels, uint32_t size)
+{
+    // First page of this size with room left.
+    const auto has_room = [&](const Page& p)
+    { return p.cell == size && (not p.free.empty() || p.used < p.capacity); };
+    auto it    = std::find_if(pages_.begin(), pages_.end(), has_room);
+    auto& page = it != pages_.end() ? *it : new_page(size, default_count);
+
+    uint32_t index = 0;
+    if (not page.free.empty())
+    {
+        index = page.free.back();
+        page.free.pop_back();
+    }
+    else
+    {
+        index = page.used++;
+    }
+
+    const auto cell = size + gutter;
+    const auto x    = static_cast<int>((index % page.columns) * cell);
+    const auto y    = static_cast<int>((index / page.columns) * cell);
+    page.texture->update(pixels, size, size, static_cast<unsigned>(x),
+                         static_cast<unsigned>(y));
+
+    live_ += 1;
+    const auto isize = static_cast<int>(size);
+    return {page.texture.get(), {x, y, isize, isize}};
+}
+
+TextureAtlas::Page* TextureAtlas::page_of(const Region& region)
+{
+    const auto it = std::find_if(pages_.begin(), pages_.end(), [&](const Page& p)
+                                 { return p.texture.get() == region.texture; });
+    return it != pages_.end() ? &*it : nullptr;
+}
+
+void TextureAtlas::update(const Region& region, const uint8_t* pixels)
+{
+    auto* page = page_of(region);
+    if (page == nullptr)
+    {
+        get_logger("TextureAtlas").error("Updated a region that isn't ours.");
+        return;
+    }
+    page->texture->update(pixels, page->cell, page->cell,
+                          static_cast<unsigned>(region.rect.left),
+                          static_cast<unsigned>(region.rect.top));
+}
+
+void TextureAtlas::release(const Region& region)
+{
+    auto* page = page_of(region);
+    if (page == nullptr)
+    {
+        get_logger("TextureAtlas").error("Released a region that isn't ours.");
+        return;
+    }
+
+    const auto cell = page->cell + gutter;
+    page->free.push_back(static_cast<uint32_t>(region.rect.top) / cell * page->columns +
+                         static_cast<uint32_t>(region.rect.left) / cell);
+    live_ -= 1;
+}
+
+void TextureAtlas::debug() const
+{
+    auto& logger = get_logger("TextureAtlas::debug");
+
+    logger.debug("Atlas: ", live_, " live region(s) in ", pages_.size(), " page(s), ",
+                 bytes_ / 1024, "KB.");
+    for (size_t i = 0; i < pages_.size(); i++)
+    {
+        const auto& page  = pages_[i];
+        const auto [w, h] = page.texture->getSize();
+        logger.debug("  Page ", i, ": ", w, "x", h, ", ", page.cell, "px cells, ",
+                     page.used - page.free.size(), "/", page.capacity, " used.");
+    }
+}
+} // namespace aa
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace aa
+{
+/* TextureAtlas
+ * Packs icons into a few big textures (pages), so that a whole turntable
+ * strip can be drawn with one texture bound, instead of one per tile, and so that
+ * we don't keep a separate GPU allocation around for every icon.
+ *
+ * Every icon in a turntable has the same size, so pages are just grids: each page
+ * holds cells of exactly one size. Icons come in already scaled (see
+ * ResampleCache), so inserting one is a plain texture upload - no render targets.
+ * Released cells get reused before a page grows a new one. Which icon lives where
+ * is up to the caller (see IconStore).
+ */
+struct TextureAtlas
+{
+    struct Region
+    {
+        // The page. Stable for the lifetime of the atlas. nullptr == no region.
+        const sf::Texture* texture = nullptr;
+        // Where in the page, in pixels.
+        sf::IntRect rect{};
+    };
+
+    // Copies size x size RGBA pixels into a free cell. This uploads, so it has to
+    // happen on the thread that owns the GL context.
+    Region insert(const uint8_t* pixels, uint32_t size);
+
+    // Overwrites a live region with new pixels (of its size). For animated icons:
+    // every tile showing the region picks up the new frame.
+    void update(const Region& region, const uint8_t* pixels);
+
+    // Gives a region back. Whatever is in it may get overwritten by the next insert.
+    void release(const Region& region);
+
+    size_t pages() const noexcept { return pages_.size(); }
+    // Of every page, assuming RGBA.
+    size_t bytes() const noexcept { return bytes_; }
+    // Regions handed out, minus the released ones.
+    size_t live() const noexcept { return live_; }
+
+    void debug() const;
+
+private:
+    struct Page
+    {
+        std::unique_ptr<sf::Texture> texture;
+        uint32_t cell;
+        // In cells.
+        uint32_t columns;
+        uint32_t capacity;
+        // High water mark. Cells below it are either live or in free.
+        uint32_t used = 0;
+        std::vector<uint32_t> free;
+    };
+
+    Page& new_page(uint32_t size, size_t count);
+    // The page region is in, nullptr if it isn't ours.
+    Page* page_of(const Region& region);
+
+    // Cells get a pixel of padding on the right and bottom, so that scaling the
+    // whole strip (or turning on smoothing) doesn't bleed neighbours in.
+    static constexpr uint32_t gutter = 1;
+    // Cells per new page. Only what is (about to be) on screen is resident (see
+    // IconStore), so that's a turntable's worth of icons in one page.
+    static constexpr size_t default_count = 256;
+
+    std::vector<Page> pages_;
+    size_t live_  = 0;
+    size_t bytes_ = 0;
+};
+} // namespace aa
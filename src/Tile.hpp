@@ -1,20 +1,26 @@
 #pragma once
 
-#include <SFML/Graphics/Sprite.hpp>
-#include <SFML/Graphics/Texture.hpp>
+#include "IconStore.hpp"
+
+#include <cstdint>
+#include <string>
 
 namespace aa
 {
 struct Tile
 {
     std::string name;
-    const sf::Texture* text;
+    // Resolved (and loaded, if need be) when the tile is drawn.
+    Icon icon;
     bool render_bg = false;
+    // What this tile represents (an advancement or criterion ordinal), so that
+    // we can find it again, e.g. to remove it once it has been completed.
+    uint32_t id = 0;
 
     // Can't remove this if we want to support like, 95% of compilers.
     // Sad face.
-    Tile(std::string name_, const sf::Texture* text_, bool render_bg_ = false)
-        : name(std::move(name_)), text(text_), render_bg(render_bg_)
+    Tile(std::string name_, Icon icon_, bool render_bg_ = false, uint32_t id_ = 0)
+        : name(std::move(name_)), icon(icon_), render_bg(render_bg_), id(id_)
     {
     }
 };
@@ -7,6 +7,13 @@
 #include <SFML/Graphics/Font.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <utility>
+#include <vector>
 
 namespace aa
 {
@@ -14,43 +21,65 @@ struct TurnTable
 {
     void animateDraw(sf::RenderWindow& win)
     {
-        auto& logger = get_logger("TurnTable::animateDraw");
-
         if (rb_.size() == 0)
         {
             // logger.debug("Empty buffer - did not render.");
             return;
         }
 
-        // This is not stellar...
-        sf::Sprite sprite;
-
         const auto winX = win.getSize().x;
 
         const auto TO_DRAW = (winX / TurnTable::tile_size) + 2;
 
-        uint64_t first = rb_.get(0).text->getSize().x;
+        // Icons are loaded on demand, in the background. Queue everything we're about
+        // to draw, and the next few tiles that will scroll in, so that it's usually
+        // resident by the time it shows up. Whatever isn't yet is left as a gap.
+        auto& icons     = aa::ResourceManager::instance().icons;
+        const auto size = static_cast<uint32_t>(inner_size);
+        upcoming_.clear();
+        for (int64_t i = 0; i < TO_DRAW + prefetch_; i++)
+        {
+            upcoming_.push_back(rb_.get(i).icon);
+        }
+        icons.prefetch(upcoming_, size);
+
+        // One quad (two triangles) per tile, batched by texture. Icons live in the
+        // atlas, so that's usually one batch - and one draw call - per strip.
+        for (auto& [_, vertices] : batches_)
+        {
+            vertices.clear();
+        }
+
         for (int64_t i = 0; i < TO_DRAW; i++)
         {
-            // set the texture of the sprite
-            const auto& [name, texture, draw_bg] = rb_.get(i);
-            const auto xv                        = texture->getSize().x;
+            const auto& tile  = rb_.get(i);
+            const auto region = icons.resolve(tile.icon, size);
 
-            if (first != xv)
+            // Integer math. Consistent & fine.
+            const auto generic_offset = static_cast<float>(tile_size * i - offset_ + xOffset_);
+            // Couldn't load it. Still leave the gap (and the text).
+            if (region.texture != nullptr)
             {
-                // Basically an assertion.
-                logger.fatal_error("Got first: ", first, " that is not equal to xv: ", xv);
+                append_quad(batch(region.texture), generic_offset, yOffset_, region.rect);
             }
+        }
 
-            sprite.setTexture(*texture);
-            // Integer math. Consistent & fine.
-            const auto generic_offset = static_cast<float>(tile_size * i - offset_ + xOffset_);
-            const auto generic_centroid = generic_offset + (xv / 2);
-            sprite.setPosition(generic_offset, yOffset_);
-            win.draw(sprite);
+        // Icons first, so that they end up under the text, like when each one was
+        // drawn right before its own text.
+        for (const auto& [texture, vertices] : batches_)
+        {
+            if (vertices.getVertexCount() != 0) win.draw(vertices, texture);
+        }
 
-            if (drawText)
+        if (drawText)
+        {
+            for (int64_t i = 0; i < TO_DRAW; i++)
             {
+                const auto& name = rb_.get(i).name;
+
+                const auto generic_offset = static_cast<float>(tile_size * i - offset_ + xOffset_);
+                const auto generic_centroid = generic_offset + (inner_size / 2);
+
                 // Temporary! I'm sure lol :)
                 if (name.find(' ') != std::string::npos)
                 {
@@ -101,6 +130,33 @@ struct TurnTable
         }
     }
 
+    sf::VertexArray& batch(const sf::Texture* texture)
+    {
+        // There's one texture per atlas page, i.e. a handful at most.
+        for (auto& [t, vertices] : batches_)
+        {
+            if (t == texture) return vertices;
+        }
+        return batches_.emplace_back(texture, sf::VertexArray{sf::Triangles}).second;
+    }
+
+    static void append_quad(sf::VertexArray& vertices, float x, float y, sf::IntRect rect)
+    {
+        const auto w  = static_cast<float>(rect.width);
+        const auto h  = static_cast<float>(rect.height);
+        const auto tx = static_cast<float>(rect.left);
+        const auto ty = static_cast<float>(rect.top);
+
+        const sf::Vertex tl{{x, y}, {tx, ty}};
+        const sf::Vertex tr{{x + w, y}, {tx + w, ty}};
+        const sf::Vertex bl{{x, y + h}, {tx, ty + h}};
+        const sf::Vertex br{{x + w, y + h}, {tx + w, ty + h}};
+        for (const auto& v : {tl, tr, bl, bl, tr, br})
+        {
+            vertices.append(v);
+        }
+    }
+
     void reset() { rb_.pos_ = 0; }
     void clear() { rb_.buf_.clear(); }
 
@@ -110,6 +166,31 @@ struct TurnTable
         rb_.buf_.emplace_back(std::forward<Ts>(ts)...);
     }
 
+    template <typename Pred>
+    auto erase_if(Pred&& pred)
+    {
+        return rb_.erase_if(std::forward<Pred>(pred));
+    }
+
+    // Removes the tiles with these ids (ascending). Needs the tiles to be sorted by
+    // id, which they are if they were emplaced that way: removing keeps the order.
+    // A binary search per id, no pass over every tile. Returns # removed.
+    size_t erase_ids(std::span<const uint32_t> ids)
+    {
+        assert(std::is_sorted(rb_.buf_.begin(), rb_.buf_.end(),
+                              [](const Tile& a, const Tile& b) { return a.id < b.id; }));
+        positions_.clear();
+        auto from = rb_.buf_.begin();
+        for (const auto id : ids)
+        {
+            from = std::lower_bound(from, rb_.buf_.end(), id,
+                                    [](const Tile& t, uint32_t value) { return t.id < value; });
+            if (from == rb_.buf_.end()) break;
+            if (from->id == id) positions_.push_back(static_cast<size_t>(from - rb_.buf_.begin()));
+        }
+        return rb_.erase_at(positions_);
+    }
+
     void set_padding(int64_t value)
     {
         padding = value;
@@ -133,6 +214,10 @@ struct TurnTable
     // Storage type - ring buffer of tiles
     RingBuffer<Tile> rb_;
     sf::Texture background_;
+    // Reused every frame, so that drawing doesn't allocate.
+    std::vector<std::pair<const sf::Texture*, sf::VertexArray>> batches_;
+    std::vector<Icon> upcoming_;
+    std::vector<size_t> positions_;
     // How far we are, into the current tile
     int64_t offset_ = 0;
 
@@ -144,6 +229,9 @@ struct TurnTable
     bool drawText = false;
     uint8_t fontSize = 12;
 
+    // How many tiles past the edge of the window to load ahead of time.
+    int64_t prefetch_ = 8;
+
 private:
     // Keep these private. Change with set_*
     int64_t padding    = 4;
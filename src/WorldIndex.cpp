@@ -0,0 +1,184 @@
+#include "WorldIndex.hpp"
+
+#include "logging.hpp"
+
+#include <algorithm>
+
+namespace aa
+{
+namespace fs = std::filesystem;
+
+WorldIndex::WorldIndex(fs::path saves_dir) : saves_(std::move(saves_dir)) {}
+
+void WorldIndex::seed()
+{
+    worlds_.clear();
+    by_time_.clear();
+    names_.clear();
+    listed_at_ = time_type::min();
+
+    std::error_code ec;
+    const auto saves_time = fs::last_write_time(saves_, ec);
+    if (ec)
+    {
+        log::debug("No saves directory at ", saves_);
+        return;
+    }
+
+    for (const auto& dir_entry : fs::directory_iterator{saves_, ec})
+    {
+        const auto mtime = dir_entry.last_write_time(ec);
+        // Deleted out from under us. Doesn't matter, it's not the newest one then.
+        if (ec) continue;
+        insert(dir_entry.path().filename().string(), mtime);
+    }
+    listed_at_ = saves_time;
+
+    log::debug("Indexed ", worlds_.size(), " worlds in ", saves_);
+}
+
+bool WorldIndex::refresh()
+{
+    std::error_code ec;
+    const auto saves_time = fs::last_write_time(saves_, ec);
+    if (ec)
+    {
+        // saves/ is gone (or was never there).
+        const bool had_worlds = not worlds_.empty();
+        worlds_.clear();
+        by_time_.clear();
+        names_.clear();
+        listed_at_ = time_type::min();
+        return had_worlds;
+    }
+    if (saves_time == listed_at_)
+    {
+        // Nothing added/removed/renamed. This is the common case.
+        return false;
+    }
+
+    // Something changed. Listing is cheap (no stats), only stat what's new.
+    // Everything we list gets marked, so whatever isn't marked afterwards is gone.
+    generation_ += 1;
+    size_t listed = 0;
+    size_t added  = 0;
+    for (const auto& dir_entry : fs::directory_iterator{saves_, ec})
+    {
+        auto name = dir_entry.path().filename().string();
+        if (const auto it = worlds_.find(name); it != worlds_.end())
+        {
+            it->second.generation = generation_;
+            listed += 1;
+            continue;
+        }
+
+        const auto mtime = dir_entry.last_write_time(ec);
+        if (ec) continue;
+        insert(std::move(name), mtime);
+        added += 1;
+    }
+
+    const auto removed = worlds_.size() - listed - added;
+    if (removed > 0)
+    {
+        for (auto it = worlds_.begin(); it != worlds_.end();)
+        {
+            if (it->second.generation == generation_)
+            {
+                ++it;
+                continue;
+            }
+            // erase() invalidates it, so step past it first.
+            const auto name = (it++)->first;
+            erase(name);
+        }
+    }
+
+    listed_at_ = saves_time;
+    return added > 0 || removed > 0;
+}
+
+void WorldIndex::update(const std::string& name)
+{
+    std::error_code ec;
+    const auto mtime = fs::last_write_time(saves_ / name, ec);
+    if (ec)
+    {
+        erase(name);
+        return;
+    }
+    insert(name, mtime);
+}
+
+bool WorldIndex::restat(size_t count)
+{
+    bool moved = false;
+    count      = std::min(count, names_.size());
+    for (size_t i = 0; i < count; i++)
+    {
+        if (cursor_ >= names_.size()) cursor_ = 0;
+        const auto name = names_[cursor_];
+        const auto it   = worlds_.find(name);
+
+        std::error_code ec;
+        const auto mtime = fs::last_write_time(saves_ / name, ec);
+        if (ec)
+        {
+            // Gone. The last name moves into this slot, so look at this slot again.
+            erase(name);
+            moved = true;
+            continue;
+        }
+        cursor_ += 1;
+        if (mtime == it->second.mtime) continue;
+
+        by_time_.erase({it->second.mtime, name});
+        it->second.mtime = mtime;
+        by_time_.emplace(mtime, name);
+        moved = true;
+    }
+    return moved;
+}
+
+std::optional<fs::path> WorldIndex::newest() const
+{
+    if (by_time_.empty())
+    {
+        return std::nullopt;
+    }
+    return saves_ / by_time_.rbegin()->second;
+}
+
+void WorldIndex::insert(std::string name, time_type mtime)
+{
+    if (const auto it = worlds_.find(name); it != worlds_.end())
+    {
+        it->second.generation = generation_;
+        if (it->second.mtime == mtime) return;
+        by_time_.erase({it->second.mtime, name});
+        it->second.mtime = mtime;
+    }
+    else
+    {
+        worlds_.emplace(name, Entry{mtime, generation_, names_.size()});
+        names_.push_back(name);
+    }
+    by_time_.emplace(mtime, std::move(name));
+}
+
+void WorldIndex::erase(const std::string& name)
+{
+    const auto it = worlds_.find(name);
+    if (it == worlds_.end()) return;
+
+    const auto slot = it->second.slot;
+    if (slot + 1 != names_.size())
+    {
+        worlds_.find(names_.back())->second.slot = slot;
+        names_[slot]                              = std::move(names_.back());
+    }
+    names_.pop_back();
+    by_time_.erase({it->second.mtime, name});
+    worlds_.erase(it);
+}
+} // namespace aa
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace aa
+{
+/* WorldIndex
+ * Every world in a saves directory, ordered by last modification time, so that
+ * "which world is newest" doesn't cost a stat per world on every poll. People
+ * who reset a lot have tens of thousands of worlds in there.
+ *
+ * seed() stats everything once. After that, the index is kept up to date by:
+ * - refresh(): one stat of saves/ itself. Its mtime only moves when worlds are
+ *   created/deleted/renamed, in which case we list the directory and only stat
+ *   the worlds we haven't seen before.
+ * - update(name): a directory watcher told us about a single entry.
+ *
+ * - restat(count): re-stats the next count worlds, round-robin. Neither of the
+ *   above notice an old world being played again (that only touches files inside
+ *   the world), this does, within size() / count calls. Cheap enough for every
+ *   poll, unlike a full seed().
+ */
+struct WorldIndex
+{
+    using time_type = std::filesystem::file_time_type;
+
+    explicit WorldIndex(std::filesystem::path saves_dir);
+
+    // Full scan. One stat per world.
+    void seed();
+
+    // Cheap check for changes. Returns true if the set of worlds changed.
+    bool refresh();
+
+    // Re-stats (or adds, or removes) the single entry saves/name.
+    void update(const std::string& name);
+
+    // Re-stats the next count worlds (all of them, at most), picking up where the
+    // last call stopped. Returns true if any of them moved (or are gone).
+    bool restat(size_t count);
+
+    // O(1). nullopt if there are no worlds (or no saves directory).
+    std::optional<std::filesystem::path> newest() const;
+
+    size_t size() const noexcept { return worlds_.size(); }
+    const std::filesystem::path& saves_dir() const noexcept { return saves_; }
+
+private:
+    void insert(std::string name, time_type mtime);
+    void erase(const std::string& name);
+
+    struct Entry
+    {
+        time_type mtime;
+        // Last refresh() that listed this world. Anything stale got deleted.
+        uint64_t generation;
+        // Where in names_.
+        size_t slot;
+    };
+
+    std::filesystem::path saves_;
+    // mtime of saves/ when we last listed it. min() == never listed.
+    time_type listed_at_ = time_type::min();
+
+    uint64_t generation_ = 0;
+
+    std::unordered_map<std::string, Entry> worlds_;
+    // Same thing, ordered by time. The newest world is at rbegin().
+    std::set<std::pair<time_type, std::string>> by_time_;
+    // Same thing again, in no particular order, for restat() to walk. Erasing swaps
+    // the last one into the hole.
+    std::vector<std::string> names_;
+    size_t cursor_ = 0;
+};
+} // namespace aa
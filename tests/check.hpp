@@ -0,0 +1,55 @@
+#pragma once
+
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+/* check.hpp
+ * Just enough of a test framework for tests/: check::that() everything, and
+ * return check::result() from main, so that ctest sees the failures. Tests that
+ * need files put them in a check::TempDir.
+ */
+namespace check
+{
+inline int failures = 0;
+
+inline void that(bool ok, std::string_view what)
+{
+    if (ok) return;
+    std::cerr << "FAILED: " << what << std::endl;
+    failures += 1;
+}
+
+inline int result()
+{
+    if (failures != 0) std::cerr << failures << " check(s) failed." << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+// A new directory under the system temp directory, with a random suffix so that
+// concurrent (or crashed) runs never share one. Removed again on the way out.
+struct TempDir
+{
+    std::filesystem::path path;
+
+    explicit TempDir(std::string_view name)
+    {
+        std::random_device random;
+        do
+        {
+            path = std::filesystem::temp_directory_path() /
+                   (std::string{name} + "_" + std::to_string(random()));
+        } while (not std::filesystem::create_directories(path));
+    }
+    ~TempDir()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    TempDir(const TempDir&)            = delete;
+    TempDir& operator=(const TempDir&) = delete;
+};
+} // namespace check
@@ -0,0 +1,167 @@
+#include "check.hpp"
+#include "dmon.hpp"
+#include "spsc_queue.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* dmon_test
+ * SpscQueue on its own, then dmon::Registry and dmon::Watch against a temporary
+ * directory: routing by prefix, generation tagged handles, and what happens when
+ * the main loop falls behind and events get dropped.
+ */
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+namespace
+{
+// How long to wait for events that should come. dmon delivers in batches.
+constexpr auto patience = 2s;
+
+// More than a watch's queue holds, so that some get dropped.
+constexpr int flood = 300;
+
+void write(const fs::path& path) { std::ofstream{path, std::ios::binary} << "{}"; }
+
+template <typename F>
+bool eventually(F&& done)
+{
+    const auto until = std::chrono::steady_clock::now() + patience;
+    while (std::chrono::steady_clock::now() < until)
+    {
+        if (done()) return true;
+        std::this_thread::sleep_for(10ms);
+    }
+    return false;
+}
+
+// dmon reports paths with forward slashes everywhere, so compare as paths.
+bool same(const std::optional<std::string>& got, const fs::path& expected)
+{
+    return got.has_value() && fs::path{*got} == expected;
+}
+
+void queue_test()
+{
+    aa::SpscQueue<int, 4> queue;
+    int pushed = 0;
+    while (queue.push_with([&](int& v) { v = pushed; })) pushed++;
+    check::that(pushed == 4, "queue: fills up at its capacity");
+
+    std::vector<int> out;
+    check::that(queue.drain([&](int& v) { out.push_back(v); }) == 4, "queue: drains everything");
+    check::that(out == std::vector<int>{0, 1, 2, 3}, "queue: drains oldest first");
+    check::that(queue.empty(), "queue: empty after draining");
+
+    // Past the end of the array, and back around.
+    out.clear();
+    for (int i = 0; i < 3; i++) queue.push_with([&](int& v) { v = i; });
+    queue.drain([&](int& v) { out.push_back(v); });
+    for (int i = 3; i < 6; i++) queue.push_with([&](int& v) { v = i; });
+    queue.drain([&](int& v) { out.push_back(v); });
+    check::that(out == std::vector<int>{0, 1, 2, 3, 4, 5}, "queue: wraps around");
+}
+
+void registry_test(const fs::path& saves)
+{
+    auto& registry = aa::dmon::Registry::instance();
+    const auto a   = saves / "a" / "advancements";
+    const auto b   = saves / "b" / "advancements";
+    fs::create_directories(a);
+    fs::create_directories(b);
+
+    auto first = registry.subscribe(saves.string(), "a/advancements/");
+    check::that(registry.alive(first), "registry: subscribed handle is alive");
+
+    std::optional<std::string> change;
+    const auto wait_for_change = [&](aa::dmon::Registry::Handle h)
+    {
+        change.reset();
+        return eventually([&] { return (change = registry.get_change(h)).has_value(); });
+    };
+
+    write(a / "x.json");
+    check::that(wait_for_change(first) && same(change, a / "x.json"), "registry: change is routed");
+
+    // Not under our prefix. Wait for a change we do get, so that b's has been through.
+    write(b / "y.json");
+    std::this_thread::sleep_for(300ms);
+    write(a / "x.json");
+    check::that(wait_for_change(first) && same(change, a / "x.json"),
+                "registry: other prefixes are filtered out");
+
+    check::that(registry.retarget(first, "b/advancements/"), "registry: retargets");
+    write(b / "y.json");
+    check::that(wait_for_change(first) && same(change, b / "y.json"),
+                "registry: retargeted handle gets the new prefix");
+
+    // The slot gets reused, but the old handle can't be used to reach it.
+    registry.unsubscribe(first);
+    check::that(not registry.alive(first), "registry: unsubscribed handle is dead");
+    const auto second = registry.subscribe(saves.string(), "a/advancements/");
+    check::that(second.slot == first.slot, "registry: slot is reused");
+    check::that(registry.alive(second) && not registry.alive(first),
+                "registry: stale handle is rejected by alive()");
+    check::that(not registry.retarget(first, "b/advancements/"),
+                "registry: stale handle can't retarget");
+    std::vector<aa::dmon::FileEvent> events;
+    check::that(not registry.drain(first, events) && events.empty(),
+                "registry: stale handle can't drain");
+    registry.unsubscribe(first);
+    check::that(registry.alive(second), "registry: stale unsubscribe leaves the new owner alone");
+
+    // More than the queue holds, while the main loop isn't looking.
+    for (int i = 0; i < flood; i++) write(a / (std::to_string(i) + ".json"));
+    std::this_thread::sleep_for(500ms);
+    events.clear();
+    check::that(not registry.drain(second, events), "registry: dropped events are reported");
+    check::that(registry.drain(second, events), "registry: overflow is only reported once");
+
+    // get_change can't know what it missed, so it looks for the newest file.
+    for (int i = 0; i < flood; i++) write(a / (std::to_string(i) + ".json"));
+    fs::last_write_time(a / "x.json", fs::file_time_type::clock::now() + 1h);
+    std::this_thread::sleep_for(500ms);
+    check::that(same(registry.get_change(second), a / "x.json"),
+                "registry: overflow falls back to the newest file");
+
+    registry.unsubscribe(second);
+}
+
+void watch_test(const fs::path& dir)
+{
+    fs::create_directories(dir);
+    auto watch = aa::dmon::Manager::instance().add_watch(dir.string());
+
+    std::vector<aa::dmon::FileEvent> events;
+    write(dir / "x.json");
+    write(dir / "x.json");
+    check::that(eventually([&] { return watch.drain(events) && not events.empty(); }),
+                "watch: change is drained");
+    check::that(events.size() == 1 && events[0].path == "x.json",
+                "watch: one event per path");
+
+    for (int i = 0; i < flood; i++) write(dir / (std::to_string(i) + ".json"));
+    std::this_thread::sleep_for(500ms);
+    events.clear();
+    check::that(not watch.drain(events), "watch: dropped events are reported");
+    check::that(watch.drain(events), "watch: overflow is only reported once");
+}
+} // namespace
+
+int main()
+{
+    queue_test();
+
+    check::TempDir temp{"trAAcker_test_dmon"};
+    registry_test(temp.path / "saves");
+    // Last: unwatching (when the Watch goes away) renumbers dmon's other watches,
+    // unless it was the newest one.
+    watch_test(temp.path / "other");
+
+    return check::result();
+}
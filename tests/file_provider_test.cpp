@@ -0,0 +1,103 @@
+#include "check.hpp"
+#include "FileProvider.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+/* file_provider_test
+ * CurrentFileProvider with one explicit instance in a temporary directory,
+ * once polling and once with native notifications (where there are any).
+ */
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+namespace
+{
+constexpr auto quiet = 30ms;
+// How long to wait for something that should come out. Only a timeout, but dmon
+// delivers in batches, 100ms apart on Linux.
+constexpr auto patience = 2s;
+
+struct FakeInstance
+{
+    check::TempDir temp{"trAAcker_test_instance"};
+    fs::path root = temp.path;
+    // Different for every run: dmon's inotify backend folds events from different
+    // watches together if their relative paths match.
+    fs::path advancements;
+    fs::path file = advancements / "uuid.json";
+    // Every write gets a newer mtime, however coarse the filesystem's clock is.
+    fs::file_time_type mtime = fs::file_time_type::clock::now();
+
+    explicit FakeInstance(std::string_view world)
+        : advancements(root / ".minecraft" / "saves" / world / "advancements")
+    {
+        fs::create_directories(advancements);
+    }
+
+    void write(std::string_view content)
+    {
+        std::ofstream{file, std::ios::binary | std::ios::trunc} << content;
+        mtime += 1s;
+        fs::last_write_time(file, mtime);
+    }
+};
+
+// Polls like the main loop does, until something comes out or for.
+std::optional<std::string> poll_for(aa::CurrentFileProvider& provider, std::chrono::milliseconds for_)
+{
+    const auto until = std::chrono::steady_clock::now() + for_;
+    while (std::chrono::steady_clock::now() < until)
+    {
+        if (auto result = provider.poll(); result.has_value()) return result;
+        std::this_thread::sleep_for(2ms);
+    }
+    return std::nullopt;
+}
+
+void run(bool native)
+{
+    const std::string mode = native ? "native: " : "polling: ";
+    const auto check = [&](bool ok, std::string_view what) { check::that(ok, mode + std::string{what}); };
+
+    FakeInstance fake{native ? "native" : "polling"};
+    fake.write(R"({"minecraft:story/root": {"done": true}, "DataVersion": 3465})");
+
+    aa::CurrentFileProvider provider{{fake.root.string()}, {1ms, 10ms}, native};
+    provider.set_debounce({quiet, 3});
+
+    // Found right away, but held back until it has been quiet for a while.
+    check(not provider.poll().has_value(), "nothing is reported before the debounce");
+    check(poll_for(provider, patience) == fake.file.string(), "existing file is reported");
+
+    // Rewritten without changes, e.g. an autosave. Filtering those is StatusParser's job.
+    fake.write(R"({"minecraft:story/root": {"done": true}, "DataVersion": 3465})");
+    check(poll_for(provider, patience) == fake.file.string(), "rewrite is reported");
+
+    // A burst of writes comes out once, after the last one.
+    const auto debounced = provider.writes_debounced();
+    fake.write(R"({"minecraft:story/root": {"done": true}, "DataVersion": 3465, "a": 1})");
+    // Past poll_max_ms, so that this poll does look (and sees the first write).
+    std::this_thread::sleep_for(15ms);
+    provider.poll();
+    fake.write(R"({"minecraft:story/root": {"done": true}, "DataVersion": 3465, "a": 2})");
+    check(poll_for(provider, patience) == fake.file.string(), "burst is reported");
+    check(not poll_for(provider, 100ms).has_value(), "burst is only reported once");
+    // With dmon, the watch folds the burst into one event before we ever see it.
+    if (not provider.has_active_watch())
+    {
+        check(provider.writes_debounced() > debounced, "burst is counted");
+    }
+}
+} // namespace
+
+int main()
+{
+    run(false);
+    run(true);
+    return check::result();
+}
@@ -0,0 +1,326 @@
+#include "AnimatedIcons.hpp"
+#include "check.hpp"
+#include "gif_decoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/* gif_decoder_test
+ * GifDecoder against tiny GIFs put together right here, byte by byte: plain
+ * frames, interlacing, disposal, streams that stop half way, and the one LZW code
+ * that isn't in the dictionary yet. Then AnimatedIcons::decode, which is what the
+ * decode workers run.
+ */
+
+namespace fs = std::filesystem;
+
+namespace
+{
+// 2 bit colour: palette index i is {i * 80, 0, 255 - i * 80}.
+constexpr uint32_t min_size = 2;
+constexpr uint32_t clear    = 1u << min_size;
+constexpr uint32_t eoi      = clear + 1;
+
+std::array<uint8_t, 4> colour(uint32_t index)
+{
+    return {static_cast<uint8_t>(index * 80), 0, static_cast<uint8_t>(255 - index * 80), 255};
+}
+
+/* Gif - a GIF89a with a 4 colour global palette, one block at a time.
+ * Image data is given as LZW codes, packed with the code size the decoder will
+ * be at, so tests can say exactly what's in the stream.
+ */
+struct Gif
+{
+    std::string bytes;
+
+    Gif(uint16_t width, uint16_t height)
+    {
+        bytes = "GIF89a";
+        word(width);
+        word(height);
+        // Global colour table of 2^(1 + 1) entries.
+        bytes += {'\x81', '\0', '\0'};
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            const auto rgba = colour(i);
+            bytes.append(reinterpret_cast<const char*>(rgba.data()), 3);
+        }
+    }
+
+    void word(uint16_t w)
+    {
+        bytes += static_cast<char>(w & 0xFF);
+        bytes += static_cast<char>(w >> 8);
+    }
+
+    Gif& control(uint16_t delay_cs, uint8_t disposal, int transparent = -1)
+    {
+        bytes += {'\x21', '\xF9', '\x04'};
+        bytes += static_cast<char>((disposal << 2) | (transparent >= 0 ? 1 : 0));
+        word(delay_cs);
+        bytes += static_cast<char>(transparent >= 0 ? transparent : 0);
+        bytes += '\0';
+        return *this;
+    }
+
+    Gif& image(uint16_t x, uint16_t y, uint16_t w, uint16_t h, std::vector<uint32_t> codes,
+               bool interlaced = false)
+    {
+        bytes += '\x2C';
+        word(x);
+        word(y);
+        word(w);
+        word(h);
+        bytes += static_cast<char>(interlaced ? 0x40 : 0);
+        bytes += static_cast<char>(min_size);
+
+        // Codes LSB first. The code size grows (like the decoder's) as entries get
+        // added: one per code after the first since the last clear.
+        std::string data;
+        uint32_t bits = 0, count = 0, code_size = min_size + 1, next_code = eoi + 1;
+        bool first = true;
+        for (const auto code : codes)
+        {
+            bits |= code << count;
+            count += code_size;
+            for (; count >= 8; count -= 8, bits >>= 8) data += static_cast<char>(bits & 0xFF);
+
+            if (code == clear)
+            {
+                code_size = min_size + 1;
+                next_code = eoi + 1;
+                first     = true;
+                continue;
+            }
+            if (not first && next_code < 4096)
+            {
+                next_code += 1;
+                if (next_code == (1u << code_size) && code_size < 12) code_size += 1;
+            }
+            first = false;
+        }
+        if (count > 0) data += static_cast<char>(bits & 0xFF);
+
+        for (size_t i = 0; i < data.size(); i += 255)
+        {
+            const auto chunk = data.substr(i, 255);
+            bytes += static_cast<char>(chunk.size());
+            bytes += chunk;
+        }
+        bytes += '\0';
+        return *this;
+    }
+
+    std::string done() const { return bytes + '\x3B'; }
+};
+
+// Every pixel as a literal, which is a valid (if pointless) LZW stream.
+std::vector<uint32_t> literals(std::initializer_list<uint32_t> indices)
+{
+    std::vector<uint32_t> ret{clear};
+    ret.insert(ret.end(), indices);
+    ret.push_back(eoi);
+    return ret;
+}
+
+struct Files
+{
+    check::TempDir temp{"trAAcker_test_gif"};
+    int count = 0;
+
+    std::string write(std::string_view contents)
+    {
+        const auto path = temp.path / (std::to_string(count++) + ".gif");
+        std::ofstream{path, std::ios::binary} << contents;
+        return path.string();
+    }
+};
+
+std::array<uint8_t, 4> pixel(const aa::GifDecoder& decoder, uint32_t x, uint32_t y)
+{
+    const auto* px = decoder.canvas().data() + (size_t{y} * decoder.width() + x) * 4;
+    return {px[0], px[1], px[2], px[3]};
+}
+
+constexpr std::array<uint8_t, 4> transparent{0, 0, 0, 0};
+
+void frames_test(Files& files)
+{
+    aa::GifDecoder decoder;
+    check::that(not decoder.open(files.write("GIF89a\x02")), "frames: truncated header fails");
+
+    Gif gif{2, 1};
+    gif.control(5, 1).image(0, 0, 2, 1, literals({1, 2}));
+    gif.control(0, 1).image(1, 0, 1, 1, literals({3}));
+    check::that(decoder.open(files.write(gif.done())), "frames: opens");
+    check::that(decoder.width() == 2 && decoder.height() == 1, "frames: canvas size");
+    check::that(decoder.frame() == aa::GifDecoder::none, "frames: nothing before next()");
+
+    check::that(decoder.next() && decoder.frame() == 0, "frames: first frame");
+    check::that(decoder.delay_ms() == 50, "frames: delay is in hundredths");
+    check::that(pixel(decoder, 0, 0) == colour(1) && pixel(decoder, 1, 0) == colour(2),
+                "frames: first frame pixels");
+
+    check::that(decoder.next() && decoder.frame() == 1, "frames: second frame");
+    check::that(pixel(decoder, 0, 0) == colour(1) && pixel(decoder, 1, 0) == colour(3),
+                "frames: second frame is drawn over the first");
+    check::that(not decoder.next() && not decoder.next(), "frames: stays at the end");
+
+    decoder.rewind();
+    check::that(decoder.next() && decoder.frame() == 0 && pixel(decoder, 1, 0) == colour(2),
+                "frames: rewinds to the first frame");
+}
+
+void interlaced_test(Files& files)
+{
+    // One pixel per row, so every row is one code. Stored in pass order.
+    constexpr uint32_t stored[] = {0, 4, 2, 6, 1, 3, 5, 7};
+    std::vector<uint32_t> codes{clear};
+    for (const auto row : stored) codes.push_back(row % 4);
+    codes.push_back(eoi);
+
+    Gif gif{1, 8};
+    gif.image(0, 0, 1, 8, codes, true);
+    aa::GifDecoder decoder;
+    check::that(decoder.open(files.write(gif.done())) && decoder.next(), "interlaced: decodes");
+
+    bool rows_ok = true;
+    for (uint32_t y = 0; y < 8; y++) rows_ok = rows_ok && pixel(decoder, 0, y) == colour(y % 4);
+    check::that(rows_ok, "interlaced: rows end up where they belong");
+}
+
+void disposal_test(Files& files)
+{
+    aa::GifDecoder decoder;
+
+    // 2: the first frame's area goes back to (transparent) background.
+    Gif background{2, 1};
+    background.control(10, 2).image(0, 0, 2, 1, literals({1, 1}));
+    background.control(10, 1).image(1, 0, 1, 1, literals({2}));
+    check::that(decoder.open(files.write(background.done())) && decoder.next() && decoder.next(),
+                "disposal 2: decodes");
+    check::that(pixel(decoder, 0, 0) == transparent && pixel(decoder, 1, 0) == colour(2),
+                "disposal 2: restores to background");
+
+    // 3: the second frame's area goes back to what was there before it.
+    Gif previous{2, 1};
+    previous.control(10, 1).image(0, 0, 2, 1, literals({1, 1}));
+    previous.control(10, 3).image(0, 0, 1, 1, literals({2}));
+    previous.control(10, 1).image(1, 0, 1, 1, literals({3}));
+    check::that(decoder.open(files.write(previous.done())) && decoder.next() && decoder.next(),
+                "disposal 3: decodes");
+    check::that(pixel(decoder, 0, 0) == colour(2), "disposal 3: second frame is drawn");
+    check::that(decoder.next() && pixel(decoder, 0, 0) == colour(1) &&
+                    pixel(decoder, 1, 0) == colour(3),
+                "disposal 3: restores to previous");
+
+    // Transparent pixels leave whatever is under them.
+    Gif holes{2, 1};
+    holes.control(10, 1).image(0, 0, 2, 1, literals({1, 1}));
+    holes.control(10, 1, 0).image(0, 0, 2, 1, literals({0, 2}));
+    check::that(decoder.open(files.write(holes.done())) && decoder.next() && decoder.next() &&
+                    pixel(decoder, 0, 0) == colour(1) && pixel(decoder, 1, 0) == colour(2),
+                "transparent index is skipped");
+}
+
+void truncated_test(Files& files)
+{
+    Gif gif{4, 1};
+    gif.control(10, 1).image(0, 0, 4, 1, literals({1, 1, 1, 1}));
+    gif.control(10, 1).image(0, 0, 4, 1, literals({2, 2, 2, 2}));
+    // Somewhere in the second frame's image data, no trailer.
+    const auto whole = gif.done();
+    const auto cut   = whole.substr(0, whole.size() - 4);
+
+    aa::GifDecoder decoder;
+    check::that(decoder.open(files.write(cut)), "truncated: opens");
+    check::that(decoder.next() && pixel(decoder, 3, 0) == colour(1),
+                "truncated: frames before the cut are fine");
+    // As far as it got is still shown, but nothing comes after it.
+    check::that(decoder.next() && decoder.frame() == 1 && pixel(decoder, 0, 0) == colour(2),
+                "truncated: partial frame is decoded as far as it goes");
+    check::that(pixel(decoder, 3, 0) == colour(1), "truncated: and no further");
+    check::that(not decoder.next(), "truncated: ends there");
+
+    decoder.rewind();
+    check::that(decoder.next() && decoder.frame() == 0, "truncated: rewinds");
+}
+
+void kwkwk_test(Files& files)
+{
+    // Code 6 is the next one to be added, so it can only be 1 + 1 (the previous
+    // string plus its own first byte).
+    Gif gif{3, 1};
+    gif.image(0, 0, 3, 1, {clear, 1, eoi + 1, eoi});
+    aa::GifDecoder decoder;
+    check::that(decoder.open(files.write(gif.done())) && decoder.next(), "KwKwK: decodes");
+    check::that(pixel(decoder, 0, 0) == colour(1) && pixel(decoder, 1, 0) == colour(1) &&
+                    pixel(decoder, 2, 0) == colour(1),
+                "KwKwK: expands to the previous string plus its first byte");
+
+    // Anything past that isn't, and the frame stops there.
+    Gif bad{3, 1};
+    bad.image(0, 0, 3, 1, {clear, 1, eoi + 2, eoi});
+    check::that(decoder.open(files.write(bad.done())) && decoder.next() &&
+                    pixel(decoder, 0, 0) == colour(1) && pixel(decoder, 1, 0) == transparent,
+                "KwKwK: codes further ahead are rejected");
+    check::that(not decoder.next(), "KwKwK: nothing after a bad code");
+}
+
+void job_test(Files& files)
+{
+    Gif gif{2, 2};
+    gif.control(0, 1).image(0, 0, 2, 2, literals({1, 1, 1, 1}));
+    gif.control(30, 1).image(0, 0, 2, 2, literals({2, 2, 2, 2}));
+    const auto path = files.write(gif.done());
+
+    aa::AnimatedIcons::Job job{7, path, {}, 1, 0, {4, 1}};
+    auto decoded = aa::AnimatedIcons::decode(std::move(job));
+    check::that(decoded.id == 7 && decoded.index == 1 && not decoded.broken,
+                "job: decodes up to the frame");
+    check::that(decoded.delays == std::vector<uint32_t>{100, 300},
+                "job: reports every delay it sees, 0 as the default");
+    check::that(decoded.frames.size() == 2 && decoded.frames[0].first == 4 &&
+                    decoded.frames[0].second.size() == 4 * 4 * 4 &&
+                    decoded.frames[1].second.size() == 4,
+                "job: scaled to every size asked for");
+    check::that(std::equal(decoded.frames[1].second.begin(), decoded.frames[1].second.end(),
+                           colour(2).begin()),
+                "job: scaled frame has the right pixels");
+
+    // The decoder comes back with the job, and carries on from where it is.
+    job     = {7, path, std::move(decoded.decoder), 2, 2, {4}};
+    decoded = aa::AnimatedIcons::decode(std::move(job));
+    check::that(decoded.complete && not decoded.broken && decoded.frames.empty() &&
+                    decoded.decodes == 0,
+                "job: past the last frame is the end");
+
+    job     = {7, path, std::move(decoded.decoder), 0, 2, {4}};
+    decoded = aa::AnimatedIcons::decode(std::move(job));
+    check::that(decoded.decodes == 1 && decoded.delays.empty() && decoded.frames.size() == 1,
+                "job: rewinds for an earlier frame");
+
+    job     = {8, files.write("not a gif"), {}, 0, 0, {4}};
+    decoded = aa::AnimatedIcons::decode(std::move(job));
+    check::that(decoded.broken, "job: not a GIF is broken");
+}
+} // namespace
+
+int main()
+{
+    Files files;
+    frames_test(files);
+    interlaced_test(files);
+    disposal_test(files);
+    truncated_test(files);
+    kwkwk_test(files);
+    job_test(files);
+    return check::result();
+}
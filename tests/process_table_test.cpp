@@ -0,0 +1,130 @@
+#include "check.hpp"
+#include "linux/ProcessTable.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+/* process_table_test
+ * ProcessTable against a fake /proc: only stat (comm + start time) and cmdline
+ * exist, which is all it reads.
+ */
+
+namespace fs = std::filesystem;
+using namespace std::string_view_literals;
+
+namespace
+{
+constexpr uint32_t recheck_every = 4;
+
+struct FakeProc
+{
+    check::TempDir temp{"trAAcker_test_proc"};
+    fs::path root = temp.path;
+
+    // Starts pid, or replaces whatever it is running (which is what exec does).
+    void run(int pid, std::string_view comm, uint64_t start_time, std::string_view cmdline)
+    {
+        const auto dir = root / std::to_string(pid);
+        fs::create_directories(dir);
+        // Fields 3 to 21 don't matter, starttime is field 22.
+        std::ofstream{dir / "stat"} << pid << " (" << comm << ") S 1 0 0 0 0 0 0 0 0 0 0 0 0 "
+                                    << "0 20 0 1 0 " << start_time << " 0 0\n";
+        std::ofstream{dir / "cmdline", std::ios::binary} << cmdline;
+    }
+
+    // Reading this pid fails from now on, as if it had just exited.
+    void break_stat(int pid) { std::ofstream{root / std::to_string(pid) / "stat"} << "garbage"; }
+
+    void exit(int pid) { fs::remove_all(root / std::to_string(pid)); }
+};
+
+constexpr auto prism = "/home/me/.local/share/PrismLauncher/instances/"sv;
+
+std::string java_cmdline(std::string_view instance)
+{
+    std::string ret{"/usr/lib/jvm/java-17/bin/java\0-Xmx4G\0-Djava.library.path="sv};
+    ret.append(prism).append(instance).append("/natives\0net.minecraft.client.main.Main\0"sv);
+    return ret;
+}
+
+std::string instance(std::string_view name) { return std::string{prism}.append(name); }
+
+void refresh(proc::ProcessTable& table, uint32_t times)
+{
+    for (uint32_t i = 0; i < times; i++) table.refresh();
+}
+} // namespace
+
+int main()
+{
+    FakeProc fake;
+    proc::ProcessTable table{fake.root.string(), recheck_every};
+
+    fake.run(1, "systemd", 1, "/sbin/init\0"sv);
+    table.refresh();
+    check::that(not table.newest_instance().has_value(), "nothing is Minecraft yet");
+
+    // New PIDs are read right away.
+    fake.run(100, "java", 5000, java_cmdline("AA"));
+    table.refresh();
+    check::that(table.newest_instance() == instance("AA"), "new instance");
+
+    // The launcher starts a wrapper, which we happen to see before it execs java.
+    // Same PID, same start time, only comm (and cmdline) change. Not Java, so it
+    // takes up to recheck_every refreshes to notice.
+    fake.run(200, "gamemoderun", 6000, "/bin/sh\0/usr/bin/gamemoderun\0java\0"sv);
+    table.refresh();
+    check::that(table.newest_instance() == instance("AA"), "a wrapper isn't Minecraft");
+    fake.run(200, "java", 6000, java_cmdline("AA 2"));
+    refresh(table, recheck_every);
+    check::that(table.newest_instance() == instance("AA 2"), "wrapper exec'd into java");
+
+    // Java PIDs are checked every time: an instance PID reused by another instance.
+    fake.exit(100);
+    fake.run(100, "java", 7000, java_cmdline("AA 3"));
+    table.refresh();
+    check::that(table.newest_instance() == instance("AA 3"), "reused instance PID");
+
+    // Everything else is only looked at again every recheck_every refreshes.
+    for (int pid = 1000; pid < 1000 + 2 * static_cast<int>(recheck_every); pid++)
+    {
+        fake.run(pid, "bash", 100, "bash\0"sv);
+    }
+    table.refresh();
+    for (int pid = 1000; pid < 1000 + 2 * static_cast<int>(recheck_every); pid++)
+    {
+        fake.break_stat(pid);
+    }
+    table.refresh();
+    auto still_cached = 0;
+    for (int pid = 1000; pid < 1000 + 2 * static_cast<int>(recheck_every); pid++)
+    {
+        still_cached += table.processes().contains(pid) ? 1 : 0;
+    }
+    check::that(still_cached == 2 * static_cast<int>(recheck_every - 1),
+                "one refresh only re-reads a slice of the non-Java PIDs");
+    refresh(table, recheck_every);
+    check::that(not table.processes().contains(1000) && not table.processes().contains(1007),
+                "every non-Java PID is re-read eventually");
+
+    // comm can contain anything, including ") ".
+    fake.run(300, "we) ird", 8000, "weird\0"sv);
+    table.refresh();
+    check::that(table.processes().at(300).start_time == 8000, "comm with a parenthesis");
+    check::that(table.newest_instance() == instance("AA 3"), "non-Java doesn't count");
+
+    // What the focused window lookup does: one PID, no refresh.
+    fake.run(400, "java", 9000, java_cmdline("AA 4"));
+    check::that(table.instance_of(400) == instance("AA 4"), "instance_of an unseen PID");
+    check::that(table.instance_of(300) == std::nullopt, "instance_of a non-Java PID");
+    fake.exit(400);
+    check::that(table.instance_of(400) == std::nullopt, "instance_of an exited PID");
+
+    fake.exit(100);
+    table.refresh();
+    check::that(table.newest_instance() == instance("AA 2"), "exited instance is forgotten");
+    check::that(not table.processes().contains(100), "exited PID is forgotten");
+
+    return check::result();
+}
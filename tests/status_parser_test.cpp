@@ -0,0 +1,128 @@
+#include "check.hpp"
+#include "StatusParser.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+
+/* status_parser_test
+ * StatusParser's fingerprints (unchanged rewrites are never parsed twice) and
+ * its handling of files caught in the middle of a write, against a two
+ * advancement manifest.
+ */
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+namespace
+{
+constexpr auto root_done = R"({"minecraft:story/root": {"done": true}, "DataVersion": 3465})";
+constexpr auto both_done =
+    R"({"minecraft:story/root": {"done": true}, "minecraft:story/mine_stone": {"done": true}})";
+
+aa::AdvancementManifest make_manifest()
+{
+    aa::AdvancementManifest ret;
+    ret.add_advancement(aa::Advancement{"root", "story", "Minecraft", "Minecraft"});
+    ret.add_advancement(aa::Advancement{"mine_stone", "story", "Stone Age", "Stone Age"});
+    return ret;
+}
+
+struct Files
+{
+    check::TempDir temp{"trAAcker_test_parser"};
+    // Every write gets a newer mtime, however coarse the filesystem's clock is.
+    fs::file_time_type mtime = fs::file_time_type::clock::now();
+
+    std::string write(std::string_view name, std::string_view content)
+    {
+        const auto path = temp.path / name;
+        std::ofstream{path, std::ios::binary | std::ios::trunc} << content;
+        mtime += 1s;
+        fs::last_write_time(path, mtime);
+        return path.string();
+    }
+};
+
+// Takes like the main loop does, until something comes out or for.
+std::optional<aa::AdvancementStatus> take_for(aa::StatusParser& parser,
+                                              std::chrono::milliseconds for_)
+{
+    const auto until = std::chrono::steady_clock::now() + for_;
+    while (std::chrono::steady_clock::now() < until)
+    {
+        if (auto status = parser.take(); status.has_value()) return status;
+        std::this_thread::sleep_for(2ms);
+    }
+    return std::nullopt;
+}
+
+size_t completed(const std::optional<aa::AdvancementStatus>& status)
+{
+    return status.has_value() && status->meta.valid ? status->complete.count() : 0;
+}
+} // namespace
+
+int main()
+{
+    const auto manifest = make_manifest();
+    aa::StatusParser parser{manifest, {30ms, 3}};
+    Files files;
+
+    const auto a = files.write("a.json", root_done);
+    parser.request(a);
+    check::that(completed(take_for(parser, 500ms)) == 1, "file is parsed");
+
+    // Rewritten without changes, e.g. an autosave.
+    files.write("a.json", root_done);
+    parser.request(a);
+    check::that(not take_for(parser, 100ms).has_value(), "unchanged rewrite is dropped");
+    check::that(parser.parses_avoided() == 1, "unchanged rewrite is counted");
+
+    // Not even rewritten (same size and mtime).
+    parser.request(a);
+    check::that(not take_for(parser, 100ms).has_value(), "untouched file is dropped");
+    check::that(parser.parses_avoided() == 2, "untouched file is counted");
+
+    // Another file, then back to the first one, unchanged: that still has to come
+    // out (it isn't what the main loop has now), but from the fingerprint.
+    const auto b = files.write("b.json", both_done);
+    parser.request(b);
+    check::that(completed(take_for(parser, 500ms)) == 2, "second file is parsed");
+    parser.request(a);
+    check::that(completed(take_for(parser, 500ms)) == 1, "first file comes back");
+    check::that(parser.parses_avoided() == 3, "first file isn't parsed again");
+
+    // Same after a cancel: whatever the main loop had is gone.
+    parser.cancel();
+    parser.request(a);
+    check::that(completed(take_for(parser, 500ms)) == 1, "unchanged file comes back after cancel");
+
+    // Caught in the middle of a write: read again until it is a whole object.
+    files.write("a.json", R"({"minecraft:story/root": {"done": tr)");
+    parser.request(a);
+    std::this_thread::sleep_for(10ms);
+    files.write("a.json", both_done);
+    check::that(completed(take_for(parser, 500ms)) == 2, "partial write is read again");
+
+    // Still partial after every retry: parsed as is, which doesn't go well.
+    files.write("a.json", R"({"minecraft:story/root": {"done": tr)");
+    parser.request(a);
+    const auto partial = take_for(parser, 500ms);
+    check::that(partial.has_value() && not partial->meta.valid, "partial write is given up on");
+
+    // A newer request doesn't wait for the partial one.
+    const auto dropped = parser.dropped();
+    files.write("b.json", R"({"minecraft:story/root": )");
+    parser.request(b);
+    std::this_thread::sleep_for(10ms);
+    files.write("a.json", root_done);
+    parser.request(a);
+    check::that(completed(take_for(parser, 500ms)) == 1, "newer request is parsed");
+    check::that(parser.dropped() > dropped, "partial write is dropped for a newer one");
+
+    return check::result();
+}